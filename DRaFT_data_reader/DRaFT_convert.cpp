@@ -0,0 +1,41 @@
+/*
+ * Offline converter from DRaFT <shot>.json files to indexed shot stores
+ *
+ * Each <shot>.json is written as <shot>.draft beside it, which the DRaFT_JSON plugin reads in
+ * preference to the JSON file. A store must be converted again whenever its JSON file changes.
+ *
+ * Usage: DRaFT_convert <shot.json> [<shot.json> ...]
+ */
+#include "DRaFT_shot_store.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <shot.json> [<shot.json> ...]\n";
+        return 2;
+    }
+    int failures{0};
+    for (int arg = 1; arg < argc; ++arg) {
+        const std::string json_path{argv[arg]};
+        const std::string store_path{std::filesystem::path{json_path}.replace_extension(DRaFT_store_extension)};
+        std::string error;
+        if (convert_DRaFT_shot(json_path, store_path, error) != 0) {
+            std::cerr << argv[0] << ": " << error << "\n";
+            ++failures;
+            continue;
+        }
+        // Read back to validate what was written
+        DRaFTShotStore store;
+        if (store.open(store_path, error) != 0) {
+            std::cerr << argv[0] << ": " << error << "\n";
+            ++failures;
+            continue;
+        }
+        std::cout << "Wrote " << store_path << "\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
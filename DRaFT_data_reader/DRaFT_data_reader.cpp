@@ -30,8 +30,195 @@
 
 #include <clientserver/stringUtils.h>
 #include <clientserver/initStructs.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
 #include "nlohmann/json.hpp"
+#include "DRaFT_shot_store.h"
+#include "DRaFT_signal_stream.h"
+
+/**
+ * Shot file cache
+ *
+ * Holds the loaded documents (parsed JSON or mapped shot store) of the most recently used shot files,
+ * bounded by capacity (LRU). A cached document is reloaded when the file modification time changes.
+ */
+template <typename Document>
+class DRaFTShotCache {
+public:
+    using Loader = std::shared_ptr<const Document> (*)(const std::string& file_path);
+
+    DRaFTShotCache(size_t capacity, Loader loader) : capacity_{capacity}, loader_{loader} {}
+
+    std::shared_ptr<const Document> get(const std::string& file_path);
+    void set_capacity(size_t capacity);
+    void clear()
+    {
+        entries_.clear();
+        lru_.clear();
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Document> document;
+        std::filesystem::file_time_type mtime;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    void evict();
+
+    size_t capacity_;
+    Loader loader_;
+    std::list<std::string> lru_; // most recently used at the front
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+template <typename Document>
+std::shared_ptr<const Document> DRaFTShotCache<Document>::get(const std::string& file_path)
+{
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(file_path, ec);
+    if (ec) {
+        // Missing/unreadable file, drop any stale entry
+        auto stale = entries_.find(file_path);
+        if (stale != entries_.end()) {
+            lru_.erase(stale->second.lru_it);
+            entries_.erase(stale);
+        }
+        return nullptr;
+    }
+
+    auto found = entries_.find(file_path);
+    if (found != entries_.end()) {
+        if (found->second.mtime == mtime) {
+            lru_.splice(lru_.begin(), lru_, found->second.lru_it);
+            return found->second.document;
+        }
+        // File changed on disk, reload below
+        lru_.erase(found->second.lru_it);
+        entries_.erase(found);
+    }
+
+    auto document = loader_(file_path);
+    if (!document) {
+        return nullptr;
+    }
+
+    lru_.push_front(file_path);
+    entries_[file_path] = Entry{document, mtime, lru_.begin()};
+    evict();
+
+    return document;
+}
+
+template <typename Document>
+void DRaFTShotCache<Document>::set_capacity(size_t capacity)
+{
+    capacity_ = capacity;
+    evict();
+}
+
+template <typename Document>
+void DRaFTShotCache<Document>::evict()
+{
+    while (entries_.size() > std::max<size_t>(capacity_, 1)) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+namespace {
+
+/**
+ * Element types of DRaFT signals. The "_type" key of a signal holds the typeid name of the type it
+ * was written from, resolved here without building a lookup table per request.
+ */
+template <typename Visitor>
+int visit_DRaFT_type(const std::string& type, Visitor&& visitor)
+{
+    if (type == typeid(int).name()) {
+        return visitor(int{});
+    }
+    if (type == typeid(float).name()) {
+        return visitor(float{});
+    }
+    if (type == typeid(double).name()) {
+        return visitor(double{});
+    }
+    return 1;
+}
+
+// Element type of a signal in a shot store
+template <typename Visitor>
+int visit_DRaFT_type(DRaFTStoreType type, Visitor&& visitor)
+{
+    switch (type) {
+        case DRaFTStoreType::INT32:
+            return visitor(int{});
+        case DRaFTStoreType::FLOAT32:
+            return visitor(float{});
+        case DRaFTStoreType::FLOAT64:
+            return visitor(double{});
+    }
+    return 1;
+}
+
+std::shared_ptr<const nlohmann::json> load_shot_json(const std::string& file_path)
+{
+    std::ifstream json_file(file_path);
+    if (!json_file) {
+        return nullptr;
+    }
+    return std::make_shared<const nlohmann::json>(nlohmann::json::parse(json_file));
+}
+
+std::shared_ptr<const DRaFTShotStore> load_shot_store(const std::string& file_path)
+{
+    auto store = std::make_shared<DRaFTShotStore>();
+    std::string error;
+    if (store->open(file_path, error) != 0) {
+        // Unusable store, the JSON file is read instead
+        UDA_LOG(UDA_LOG_ERROR, "DRaFTDataReaderPlugin - %s\n", error.c_str());
+        return nullptr;
+    }
+    return store;
+}
+
+// Typed setReturnData overloads, any other element type fails to compile
+int set_return_array(DATA_BLOCK* data_block, int* values, size_t rank, const size_t* shape)
+{
+    return setReturnDataIntArray(data_block, values, rank, shape, nullptr);
+}
+int set_return_array(DATA_BLOCK* data_block, float* values, size_t rank, const size_t* shape)
+{
+    return setReturnDataFloatArray(data_block, values, rank, shape, nullptr);
+}
+int set_return_array(DATA_BLOCK* data_block, double* values, size_t rank, const size_t* shape)
+{
+    return setReturnDataDoubleArray(data_block, values, rank, shape, nullptr);
+}
+int set_return_scalar(DATA_BLOCK* data_block, int value)
+{
+    return setReturnDataIntScalar(data_block, value, nullptr);
+}
+int set_return_scalar(DATA_BLOCK* data_block, float value)
+{
+    return setReturnDataFloatScalar(data_block, value, nullptr);
+}
+int set_return_scalar(DATA_BLOCK* data_block, double value)
+{
+    return setReturnDataDoubleScalar(data_block, value, nullptr);
+}
+
+} // namespace
 
 class DRaFTDataReaderPlugin {
 public:
@@ -43,6 +230,15 @@ public:
                 || STR_IEQUALS(request->function, "initialise")) {
             reset(plugin_interface);
             // Initialise plugin
+            const char* cache_size = getenv("DRaFT_CACHE_SIZE");
+            if (cache_size != nullptr) {
+                shot_cache_.set_capacity(std::strtoul(cache_size, nullptr, 10));
+                store_cache_.set_capacity(std::strtoul(cache_size, nullptr, 10));
+            }
+            // STREAM reads each signal from the JSON file with the SAX parser instead of caching the
+            // parsed shot
+            const char* json_mode = getenv("DRaFT_JSON_MODE");
+            stream_json_ = json_mode != nullptr && STR_IEQUALS(json_mode, "STREAM");
             init_ = true;
         }
     }
@@ -53,6 +249,8 @@ public:
             return;
         }
         // Free Heap & reset counters
+        shot_cache_.clear();
+        store_cache_.clear();
         init_ = false;
     }
 
@@ -62,12 +260,22 @@ public:
     int default_method(IDAM_PLUGIN_INTERFACE* plugin_interface);
     int max_interface_version(IDAM_PLUGIN_INTERFACE* plugin_interface);
     int get(IDAM_PLUGIN_INTERFACE* plugin_interface);
+    int shape(IDAM_PLUGIN_INTERFACE* plugin_interface);
 
 private:
     int return_DRaFT_data(DATA_BLOCK* data_block, int shot, std::string signal);
     int return_DRaFT_data_time(DATA_BLOCK* data_block, int shot, std::string signal);
-    nlohmann::json read_json_data(std::string signal, int shot);
+    int return_store_data(DATA_BLOCK* data_block, const DRaFTShotStore& store, const std::string& signal);
+    int return_streamed_data(DATA_BLOCK* data_block, int shot, const std::string& signal);
+    std::string shot_path(int shot, const char* extension);
+    std::shared_ptr<const nlohmann::json> read_shot_data(int shot);
+    std::shared_ptr<const DRaFTShotStore> read_shot_store(int shot);
+    const nlohmann::json& read_json_data(const nlohmann::json& shot_data, const std::string& signal);
     bool init_ = false;
+    bool stream_json_ = false;
+    DRaFTShotCache<nlohmann::json> shot_cache_{4, load_shot_json};
+    // Indexed <shot>.draft stores, read in preference to <shot>.json
+    DRaFTShotCache<DRaFTShotStore> store_cache_{4, load_shot_store};
 };
 
 int DRaFTDataReaderPlugin::get(IDAM_PLUGIN_INTERFACE* interface) {
@@ -102,12 +310,115 @@ int DRaFTDataReaderPlugin::get(IDAM_PLUGIN_INTERFACE* interface) {
         return_DRaFT_data(interface->data_block, source, signal_str);
 }
 
+/**
+ * Shape of a signal without returning its data, used for array of structure
+ * sizing. Returns an int array of dimension lengths in UDA dims order (dims[0]
+ * varies fastest, ie. innermost JSON array first), empty for scalars.
+ * @param interface
+ * @return
+ */
+int DRaFTDataReaderPlugin::shape(IDAM_PLUGIN_INTERFACE* interface) {
+
+    DATA_BLOCK* data_block = interface->data_block;
+    REQUEST_DATA* request_data = interface->request_data;
+
+    initDataBlock(data_block);
+
+    int source{0};
+    FIND_REQUIRED_INT_VALUE(request_data->nameValueList, source);
+    const char* signal{nullptr};
+    FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, signal);
+
+    std::vector<int> dims;
+    const auto store = read_shot_store(source);
+    if (store) {
+        // Shape from the store index, the data is never touched
+        const auto* record = store->find(signal);
+        if (record == nullptr) {
+            RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::shape - Signal not in shot store");
+        }
+        const uint64_t* shape = store->shape(*record);
+        dims.assign(shape, shape + record->rank);
+    } else if (stream_json_) {
+        // Lengths counted while streaming, the values are not kept
+        DRaFTStreamedSignal streamed;
+        std::string error;
+        if (stream_DRaFT_signal(shot_path(source, ".json"), signal, DRaFTStreamFields::SHAPE, streamed, error) != 0) {
+            error.insert(0, "DRaFTDataReaderPlugin::shape - ");
+            RAISE_PLUGIN_ERROR(error.c_str());
+        }
+        dims.assign(streamed.shape.begin(), streamed.shape.end());
+    } else {
+        const auto shot_data = read_shot_data(source);
+        if (!shot_data) {
+            RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::shape - Cannot read shot file");
+        }
+        // An unknown signal is an error, not an empty signal
+        const auto found = shot_data->find(signal);
+        if (found == shot_data->end()) {
+            RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::shape - Signal not in shot file");
+        }
+        // Lengths of the nested arrays, the values are never converted
+        const nlohmann::json* node = &*found;
+        while (node->is_array()) {
+            dims.push_back(static_cast<int>(node->size()));
+            if (node->empty()) {
+                break;
+            }
+            node = &node->front();
+        }
+    }
+
+    // Store, stream and JSON shapes are row-major (outermost first)
+    std::reverse(dims.begin(), dims.end());
+    const size_t n_dims{dims.size()};
+    return setReturnDataIntArray(data_block, dims.data(), 1, &n_dims, "Signal shape");
+}
+
 int DRaFTDataReaderPlugin::return_DRaFT_data_time(DATA_BLOCK* data_block, int shot, std::string signal) {
 
-    const auto data = read_json_data(signal, shot);
-    auto vec_values = data.get<std::vector<float>>();
-    const size_t shape{vec_values.size()};
-    int err = setReturnDataFloatArray(data_block, vec_values.data(),
+    std::vector<float> vec_values;
+    const float* values{nullptr};
+    size_t shape{0};
+    const auto store = read_shot_store(shot);
+    if (store) {
+        const auto* record = store->find(signal);
+        if (record == nullptr) {
+            RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_DRaFT_data_time - Signal not in shot store");
+        }
+        shape = record->element_count;
+        if (record->type == DRaFTStoreType::FLOAT32) {
+            // Copied once, straight from the mapped store
+            values = static_cast<const float*>(store->values(*record));
+        } else {
+            visit_DRaFT_type(record->type, [&](auto tag) {
+                using T = decltype(tag);
+                const auto* typed_values = static_cast<const T*>(store->values(*record));
+                vec_values.assign(typed_values, typed_values + shape);
+                return 0;
+            });
+            values = vec_values.data();
+        }
+    } else if (stream_json_) {
+        DRaFTStreamedSignal streamed;
+        std::string error;
+        if (stream_DRaFT_signal(shot_path(shot, ".json"), signal, DRaFTStreamFields::VALUES, streamed, error) != 0) {
+            error.insert(0, "DRaFTDataReaderPlugin::return_DRaFT_data_time - ");
+            RAISE_PLUGIN_ERROR(error.c_str());
+        }
+        vec_values.assign(streamed.values.begin(), streamed.values.end());
+        values = vec_values.data();
+        shape = vec_values.size();
+    } else {
+        const auto shot_data = read_shot_data(shot);
+        if (!shot_data) {
+            RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_DRaFT_data_time - Cannot read shot file");
+        }
+        vec_values = read_json_data(*shot_data, signal).get<std::vector<float>>();
+        values = vec_values.data();
+        shape = vec_values.size();
+    }
+    int err = setReturnDataFloatArray(data_block, const_cast<float*>(values),
                                     1, &shape, nullptr);
     // Cleanup to make things behave
     data_block->order = -1;
@@ -123,87 +434,152 @@ int DRaFTDataReaderPlugin::return_DRaFT_data_time(DATA_BLOCK* data_block, int sh
 
 int DRaFTDataReaderPlugin::return_DRaFT_data(DATA_BLOCK* data_block, int shot, std::string signal) {
 
+    const auto store = read_shot_store(shot);
+    if (store) {
+        return return_store_data(data_block, *store, signal);
+    }
+    if (stream_json_) {
+        return return_streamed_data(data_block, shot, signal);
+    }
+
     int err{1};
-    const auto data = read_json_data(signal, shot);
-    const auto type = read_json_data(signal+"_type", shot).get<std::string>();
-    const auto rank = read_json_data(signal+"_rank", shot).get<int>();
-
-    const std::unordered_map<std::string, UDA_TYPE> UDA_TYPE_MAP{
-        {typeid(int).name(), UDA_TYPE_INT},
-        {typeid(float).name(), UDA_TYPE_FLOAT},
-        {typeid(double).name(), UDA_TYPE_DOUBLE}
-    };
+    // One parse (at most) per shot, signal and metadata read from the same document
+    const auto shot_data = read_shot_data(shot);
+    if (!shot_data) {
+        RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_DRaFT_data - Cannot read shot file");
+    }
+    const auto& data = read_json_data(*shot_data, signal);
+    const auto type = read_json_data(*shot_data, signal+"_type").get<std::string>();
+    const auto rank = read_json_data(*shot_data, signal+"_rank").get<int>();
 
     // All DRaFT data is rank 1 : other experiments would need to expand
-    if (rank > 0) {
-        switch (UDA_TYPE_MAP.at(type)) {
-        case UDA_TYPE_INT: {
-            auto vec_values = data.get<std::vector<int>>();
-            const size_t shape{vec_values.size()};
-            err = setReturnDataIntArray(data_block, vec_values.data(),
-                                        rank, &shape, nullptr);
-            break;
-        }
-        case UDA_TYPE_FLOAT: {
-            auto vec_values = data.get<std::vector<float>>();
+    err = visit_DRaFT_type(type, [&](auto tag) {
+        using T = decltype(tag);
+        if (rank > 0) {
+            auto vec_values = data.get<std::vector<T>>();
             const size_t shape{vec_values.size()};
-            err = setReturnDataFloatArray(data_block, vec_values.data(),
-                                          rank, &shape, nullptr);
-            break;
+            return set_return_array(data_block, vec_values.data(), rank, &shape);
         }
-        case UDA_TYPE_DOUBLE: {
-            auto vec_values = data.get<std::vector<double>>();
-            const size_t shape{vec_values.size()};
-            err = setReturnDataDoubleArray(data_block, vec_values.data(),
-                                           rank, &shape, nullptr);
-            break;
-        }
-        default: {
-            break;
-        }}
+        return set_return_scalar(data_block, data.get<T>());
+    });
+    if (err) {
+        RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_DRaFT_data - Unsupported signal type");
+    }
+
+    return 0;
+}
 
-    } else if (rank == 0) {
+/**
+ * Return one signal of a shot store, its values are copied once from the mapped file into the data block
+ */
+int DRaFTDataReaderPlugin::return_store_data(DATA_BLOCK* data_block, const DRaFTShotStore& store,
+                                             const std::string& signal) {
 
-        switch (UDA_TYPE_MAP.at(type)) {
-        case UDA_TYPE_INT: {
-            auto value = data.get<int>();
-            err = setReturnDataIntScalar(data_block, value, nullptr);
-            break;
-        }
-        case UDA_TYPE_FLOAT: {
-            auto value = data.get<float>();
-            err = setReturnDataFloatScalar(data_block, value, nullptr);
-            break;
-        }
-        case UDA_TYPE_DOUBLE: {
-            auto value = data.get<double>();
-            err = setReturnDataDoubleScalar(data_block, value, nullptr);
-            break;
-        }
-        default: {
-            break;
+    const auto* record = store.find(signal);
+    if (record == nullptr) {
+        RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_store_data - Signal not in shot store");
+    }
+    // Row-major store shape, reversed so dims[0] is the fastest varying
+    const uint64_t* store_shape = store.shape(*record);
+    const std::vector<size_t> shape(std::make_reverse_iterator(store_shape + record->rank),
+                                    std::make_reverse_iterator(store_shape));
+
+    const int err = visit_DRaFT_type(record->type, [&](auto tag) {
+        using T = decltype(tag);
+        const auto* values = static_cast<const T*>(store.values(*record));
+        if (record->rank > 0) {
+            return set_return_array(data_block, const_cast<T*>(values), shape.size(), shape.data());
         }
+        return set_return_scalar(data_block, values[0]);
+    });
+    if (err) {
+        RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_store_data - Unsupported signal type");
+    }
+
+    return 0;
+}
+
+/**
+ * Return one signal of a JSON shot file without parsing the shot, only the signal values are held in memory
+ */
+int DRaFTDataReaderPlugin::return_streamed_data(DATA_BLOCK* data_block, int shot, const std::string& signal) {
+
+    DRaFTStreamedSignal streamed;
+    std::string error;
+    if (stream_DRaFT_signal(shot_path(shot, ".json"), signal, DRaFTStreamFields::VALUES_AND_METADATA, streamed,
+                            error) != 0) {
+        error.insert(0, "DRaFTDataReaderPlugin::return_streamed_data - ");
+        RAISE_PLUGIN_ERROR(error.c_str());
+    }
+    if (streamed.rank > 0 && streamed.shape.empty()) {
+        streamed.shape.push_back(streamed.values.size());
+    }
+    // Row-major streamed shape, reversed so dims[0] is the fastest varying
+    std::reverse(streamed.shape.begin(), streamed.shape.end());
+
+    const int err = visit_DRaFT_type(streamed.type, [&](auto tag) {
+        using T = decltype(tag);
+        if (streamed.shape.empty()) {
+            return set_return_scalar(data_block, static_cast<T>(streamed.values.front()));
         }
+        std::vector<T> vec_values(streamed.values.begin(), streamed.values.end());
+        return set_return_array(data_block, vec_values.data(), streamed.shape.size(), streamed.shape.data());
+    });
+    if (err) {
+        RAISE_PLUGIN_ERROR("DRaFTDataReaderPlugin::return_streamed_data - Unsupported signal type");
     }
 
     return 0;
-}   
+}
+
+std::string DRaFTDataReaderPlugin::shot_path(int shot, const char* extension) {
 
-nlohmann::json DRaFTDataReaderPlugin::read_json_data(std::string signal, int shot) {
+    const char* data_dir = getenv("DRaFT_DATA_DIR");
+    if (data_dir == nullptr) {
+        return {};
+    }
+    return std::string{data_dir} + "/" + std::to_string(shot) + extension;
+}
 
-    std::string map_dir = getenv("DRaFT_DATA_DIR");
-    std::string data_path = map_dir + "/" + std::to_string(shot) + ".json";
-    std::ifstream json_file(data_path);
-    auto temp_json = nlohmann::json::parse(json_file);
-    json_file.close();
+std::shared_ptr<const nlohmann::json> DRaFTDataReaderPlugin::read_shot_data(int shot) {
 
-    try {
-        temp_json = temp_json.at(signal);
-    } catch (std::exception& e) {
-        temp_json = nlohmann::json::parse("[]");
+    const auto data_path = shot_path(shot, ".json");
+    if (data_path.empty()) {
+        return nullptr;
+    }
+    return shot_cache_.get(data_path);
+}
+
+std::shared_ptr<const DRaFTShotStore> DRaFTDataReaderPlugin::read_shot_store(int shot) {
+
+    const auto store_path = shot_path(shot, DRaFT_store_extension);
+    if (store_path.empty()) {
+        return nullptr;
+    }
+    // A store older than its shot JSON is stale (JSON rewritten after the
+    // conversion), the JSON is read instead
+    std::error_code ec;
+    const auto store_mtime = std::filesystem::last_write_time(store_path, ec);
+    if (ec) {
+        return nullptr;
     }
+    const auto json_mtime = std::filesystem::last_write_time(shot_path(shot, ".json"), ec);
+    if (!ec && json_mtime > store_mtime) {
+        UDA_LOG(UDA_LOG_DEBUG, "DRaFTDataReaderPlugin - %s older than shot JSON, not used\n",
+                store_path.c_str());
+        return nullptr;
+    }
+    return store_cache_.get(store_path);
+}
 
-    return temp_json;
+const nlohmann::json& DRaFTDataReaderPlugin::read_json_data(const nlohmann::json& shot_data, const std::string& signal) {
+
+    static const nlohmann::json empty_data = nlohmann::json::array();
+    auto found = shot_data.find(signal);
+    if (found == shot_data.end()) {
+        return empty_data;
+    }
+    return *found;
 }
 
 int DRaFTDataReader(IDAM_PLUGIN_INTERFACE* plugin_interface) {
@@ -232,6 +608,10 @@ int DRaFTDataReader(IDAM_PLUGIN_INTERFACE* plugin_interface) {
     // Calls to plugins must also respect access policy and user authentication policy
 
     try {
+        // Calls are serialised, the shot caches are not thread safe and the mapping plugin may prefetch from
+        // worker threads
+        static std::mutex plugin_mutex;
+        std::lock_guard<std::mutex> lock(plugin_mutex);
         static DRaFTDataReaderPlugin plugin = {};
         auto* const plugin_func = request->function;
 
@@ -267,6 +647,8 @@ int DRaFTDataReader(IDAM_PLUGIN_INTERFACE* plugin_interface) {
             return plugin.max_interface_version(plugin_interface);
         } else if (STR_IEQUALS(plugin_func, "get")) {
             return plugin.get(plugin_interface);
+        } else if (STR_IEQUALS(plugin_func, "shape")) {
+            return plugin.shape(plugin_interface);
         } else {
             RAISE_PLUGIN_ERROR("Unknown function requested!");
         } 
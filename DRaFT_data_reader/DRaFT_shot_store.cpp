@@ -0,0 +1,348 @@
+#include "DRaFT_shot_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <typeinfo>
+#include <unistd.h>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+namespace {
+
+bool host_little_endian()
+{
+    const uint16_t probe{1};
+    unsigned char first_byte;
+    std::memcpy(&first_byte, &probe, 1);
+    return first_byte == 1;
+}
+
+size_t align8(size_t offset)
+{
+    return (offset + 7) & ~size_t{7};
+}
+
+/**
+ * Flatten a (nested) numeric JSON array row-major, recording its shape. Fails for ragged arrays and
+ * non-numeric values.
+ */
+bool flatten(const nlohmann::json& node, size_t depth, std::vector<uint64_t>& shape,
+             std::vector<const nlohmann::json*>& leaves)
+{
+    if (node.is_array()) {
+        if (depth == shape.size() && leaves.empty()) {
+            shape.push_back(node.size());
+        } else if (depth >= shape.size() || shape[depth] != node.size()) {
+            return false;
+        }
+        for (const auto& element : node) {
+            if (!flatten(element, depth + 1, shape, leaves)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (!node.is_number() || depth != shape.size()) {
+        return false;
+    }
+    leaves.push_back(&node);
+    return true;
+}
+
+template <typename T>
+void append_values(std::vector<char>& buffer, const std::vector<const nlohmann::json*>& leaves)
+{
+    const size_t offset = buffer.size();
+    buffer.resize(offset + leaves.size() * sizeof(T));
+    char* out = buffer.data() + offset;
+    for (const auto* leaf : leaves) {
+        const auto value = leaf->get<T>();
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+}
+
+bool has_metadata_suffix(const std::string& key, const nlohmann::json& shot_data)
+{
+    for (const std::string suffix : {"_type", "_rank"}) {
+        if (key.size() > suffix.size()
+                && key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0
+                && shot_data.contains(key.substr(0, key.size() - suffix.size()))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+size_t DRaFT_type_size(DRaFTStoreType type)
+{
+    switch (type) {
+        case DRaFTStoreType::INT32:
+            return sizeof(int32_t);
+        case DRaFTStoreType::FLOAT32:
+            return sizeof(float);
+        case DRaFTStoreType::FLOAT64:
+            return sizeof(double);
+    }
+    return 0;
+}
+
+/**
+ * Store type of a DRaFT "_type" key, the typeid name of the type the signal was written from
+ */
+bool parse_DRaFT_type(const std::string& type_name, DRaFTStoreType& type)
+{
+    if (type_name == typeid(int).name()) {
+        type = DRaFTStoreType::INT32;
+    } else if (type_name == typeid(float).name()) {
+        type = DRaFTStoreType::FLOAT32;
+    } else if (type_name == typeid(double).name()) {
+        type = DRaFTStoreType::FLOAT64;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Convert a DRaFT <shot>.json file into an indexed shot store
+ *
+ * Every numeric signal (scalar or rectangular array) is stored with the type of its "_type" key, or
+ * int/double by value if it has none. The "_type" and "_rank" keys themselves and non-numeric values
+ * are not stored. The store is written beside the destination and renamed into place, so a reader
+ * never maps a partial file.
+ *
+ * @return 0 on success, error describes the failure otherwise
+ */
+int convert_DRaFT_shot(const std::string& json_path, const std::string& store_path, std::string& error)
+{
+    if (!host_little_endian()) {
+        error = "shot stores are little-endian, unsupported host";
+        return 1;
+    }
+    std::ifstream json_file(json_path);
+    if (!json_file) {
+        error = "cannot open " + json_path;
+        return 1;
+    }
+    nlohmann::json shot_data;
+    try {
+        json_file >> shot_data;
+    } catch (const nlohmann::json::exception& ex) {
+        error = json_path + ": " + ex.what();
+        return 1;
+    }
+    if (!shot_data.is_object()) {
+        error = json_path + " is not a DRaFT shot file";
+        return 1;
+    }
+
+    std::vector<char> data(sizeof(DRaFTStoreHeader));
+    std::vector<DRaFTSignalRecord> index;
+    std::vector<uint64_t> shapes;
+    std::string names;
+
+    std::vector<uint64_t> shape;
+    std::vector<const nlohmann::json*> leaves;
+    for (const auto& [key, value] : shot_data.items()) {
+        shape.clear();
+        leaves.clear();
+        if (has_metadata_suffix(key, shot_data) || !flatten(value, 0, shape, leaves)
+                || shape.size() > std::numeric_limits<uint8_t>::max()) {
+            continue;
+        }
+
+        DRaFTStoreType type;
+        const auto type_name = shot_data.find(key + "_type");
+        if (type_name == shot_data.end() || !type_name->is_string()
+                || !parse_DRaFT_type(type_name->get<std::string>(), type)) {
+            const bool integral = std::all_of(leaves.begin(), leaves.end(),
+                                              [](const nlohmann::json* leaf) { return leaf->is_number_integer(); });
+            type = integral ? DRaFTStoreType::INT32 : DRaFTStoreType::FLOAT64;
+        }
+
+        DRaFTSignalRecord record{};
+        data.resize(align8(data.size()));
+        record.data_offset = data.size();
+        record.element_count = leaves.size();
+        record.name_offset = static_cast<uint32_t>(names.size());
+        record.name_length = static_cast<uint32_t>(key.size());
+        record.shape_index = static_cast<uint32_t>(shapes.size());
+        record.type = type;
+        record.rank = static_cast<uint8_t>(shape.size());
+        switch (type) {
+            case DRaFTStoreType::INT32:
+                append_values<int32_t>(data, leaves);
+                break;
+            case DRaFTStoreType::FLOAT32:
+                append_values<float>(data, leaves);
+                break;
+            case DRaFTStoreType::FLOAT64:
+                append_values<double>(data, leaves);
+                break;
+        }
+        index.push_back(record);
+        shapes.insert(shapes.end(), shape.begin(), shape.end());
+        names.append(key);
+        if (names.size() > std::numeric_limits<uint32_t>::max()) {
+            error = json_path + ": too many signal names";
+            return 1;
+        }
+    }
+
+    DRaFTStoreHeader header{};
+    std::copy(std::begin(DRaFT_store_magic), std::end(DRaFT_store_magic), header.magic);
+    header.format_version = DRaFT_store_format_version;
+    header.signal_count = static_cast<uint32_t>(index.size());
+    header.index_offset = align8(data.size());
+    header.shapes_offset = header.index_offset + index.size() * sizeof(DRaFTSignalRecord);
+    header.names_offset = header.shapes_offset + shapes.size() * sizeof(uint64_t);
+    header.shape_count = static_cast<uint32_t>(shapes.size());
+    header.file_size = header.names_offset + names.size();
+
+    data.resize(header.index_offset);
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    const std::string temp_path{store_path + ".tmp"};
+    std::ofstream store_file(temp_path, std::ios::binary | std::ios::trunc);
+    store_file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    store_file.write(reinterpret_cast<const char*>(index.data()),
+                     static_cast<std::streamsize>(index.size() * sizeof(DRaFTSignalRecord)));
+    store_file.write(reinterpret_cast<const char*>(shapes.data()),
+                     static_cast<std::streamsize>(shapes.size() * sizeof(uint64_t)));
+    store_file.write(names.data(), static_cast<std::streamsize>(names.size()));
+    store_file.close();
+    if (!store_file) {
+        std::remove(temp_path.c_str());
+        error = "cannot write " + temp_path;
+        return 1;
+    }
+    if (std::rename(temp_path.c_str(), store_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        error = "cannot rename " + temp_path + " to " + store_path;
+        return 1;
+    }
+    return 0;
+}
+
+DRaFTShotStore::~DRaFTShotStore()
+{
+    close();
+}
+
+/**
+ * Map a shot store and validate its index
+ *
+ * @return 0 on success, error describes the failure otherwise
+ */
+int DRaFTShotStore::open(const std::string& store_path, std::string& error)
+{
+    close();
+    if (!host_little_endian()) {
+        error = "shot stores are little-endian, unsupported host";
+        return 1;
+    }
+    const int fd = ::open(store_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "cannot open " + store_path;
+        return 1;
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(DRaFTStoreHeader)) {
+        ::close(fd);
+        error = store_path + " is not a DRaFT shot store";
+        return 1;
+    }
+    const auto size = static_cast<size_t>(file_stat.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "cannot map " + store_path;
+        return 1;
+    }
+    data_ = static_cast<const char*>(mapped);
+    size_ = size;
+
+    if (read_index(error) != 0) {
+        close();
+        error.insert(0, store_path + ": ");
+        return 1;
+    }
+    return 0;
+}
+
+void DRaFTShotStore::close()
+{
+    index_.clear();
+    shapes_ = nullptr;
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+int DRaFTShotStore::read_index(std::string& error)
+{
+    DRaFTStoreHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (!std::equal(std::begin(DRaFT_store_magic), std::end(DRaFT_store_magic), header.magic)) {
+        error = "not a DRaFT shot store";
+        return 1;
+    }
+    if (header.format_version != DRaFT_store_format_version) {
+        error = "unsupported shot store format version " + std::to_string(header.format_version);
+        return 1;
+    }
+    if (header.file_size != size_ || header.index_offset < sizeof(header) || header.index_offset % 8 != 0
+            || header.shapes_offset < header.index_offset || header.names_offset < header.shapes_offset
+            || header.names_offset > size_
+            || (header.shapes_offset - header.index_offset) / sizeof(DRaFTSignalRecord) < header.signal_count
+            || (header.names_offset - header.shapes_offset) / sizeof(uint64_t) < header.shape_count) {
+        error = "shot store truncated or corrupt";
+        return 1;
+    }
+
+    const auto* records = reinterpret_cast<const DRaFTSignalRecord*>(data_ + header.index_offset);
+    shapes_ = reinterpret_cast<const uint64_t*>(data_ + header.shapes_offset);
+    const char* names = data_ + header.names_offset;
+    const uint64_t names_size = size_ - header.names_offset;
+
+    index_.reserve(header.signal_count);
+    for (uint32_t i = 0; i < header.signal_count; ++i) {
+        const auto& record = records[i];
+        const size_t type_size = DRaFT_type_size(record.type);
+        uint64_t element_count = 1;
+        bool valid = type_size != 0
+                && uint64_t{record.name_offset} + record.name_length <= names_size
+                && uint64_t{record.shape_index} + record.rank <= header.shape_count
+                && record.data_offset >= sizeof(header) && record.data_offset % type_size == 0
+                && record.data_offset <= header.index_offset
+                && record.element_count <= (header.index_offset - record.data_offset) / type_size;
+        for (uint8_t dim = 0; valid && dim < record.rank; ++dim) {
+            const uint64_t length = shapes_[record.shape_index + dim];
+            valid = length == 0 || element_count <= std::numeric_limits<uint64_t>::max() / length;
+            element_count *= length;
+        }
+        if (!valid || element_count != record.element_count) {
+            error = "corrupt signal record " + std::to_string(i);
+            return 1;
+        }
+        index_.emplace(std::string_view{names + record.name_offset, record.name_length}, &record);
+    }
+    return 0;
+}
+
+const DRaFTSignalRecord* DRaFTShotStore::find(std::string_view signal) const
+{
+    const auto found = index_.find(signal);
+    return found != index_.end() ? found->second : nullptr;
+}
@@ -0,0 +1,87 @@
+#ifndef DRaFT_SHOT_STORE_H
+#define DRaFT_SHOT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * Indexed DRaFT shot store, a <shot>.json file converted offline (DRaFT_convert) into a binary file
+ * which is memory-mapped and read one signal at a time, without parsing the shot.
+ *
+ * Layout (little-endian, 8 byte aligned sections):
+ *   DRaFTStoreHeader
+ *   signal data: raw arrays, row-major
+ *   index: DRaFTSignalRecord[signal_count]
+ *   shape table: uint64_t[shape_count], rank entries per signal
+ *   names: signal name characters
+ */
+inline constexpr char DRaFT_store_magic[8]{'D', 'R', 'a', 'F', 'T', 'S', 'H', 'T'};
+inline constexpr uint32_t DRaFT_store_format_version{1};
+inline constexpr const char* DRaFT_store_extension{".draft"};
+
+enum class DRaFTStoreType : uint8_t { INT32, FLOAT32, FLOAT64 };
+
+struct DRaFTStoreHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t signal_count;
+    uint64_t file_size;
+    uint64_t index_offset;
+    uint64_t shapes_offset;
+    uint64_t names_offset;
+    uint32_t shape_count;
+    uint32_t reserved[3];
+};
+static_assert(sizeof(DRaFTStoreHeader) == 64);
+
+struct DRaFTSignalRecord {
+    uint64_t data_offset;
+    uint64_t element_count;
+    uint32_t name_offset;
+    uint32_t name_length;
+    // First of rank entries in the shape table
+    uint32_t shape_index;
+    DRaFTStoreType type;
+    uint8_t rank;
+    uint16_t reserved;
+};
+static_assert(sizeof(DRaFTSignalRecord) == 32);
+
+size_t DRaFT_type_size(DRaFTStoreType type);
+bool parse_DRaFT_type(const std::string& type_name, DRaFTStoreType& type);
+
+int convert_DRaFT_shot(const std::string& json_path, const std::string& store_path, std::string& error);
+
+/**
+ * Read-only view of a memory-mapped shot store
+ *
+ * The header, index and every record are validated on open, signal data is only touched when read.
+ */
+class DRaFTShotStore {
+public:
+    DRaFTShotStore() = default;
+    ~DRaFTShotStore();
+    DRaFTShotStore(const DRaFTShotStore&) = delete;
+    DRaFTShotStore& operator=(const DRaFTShotStore&) = delete;
+
+    int open(const std::string& store_path, std::string& error);
+    void close();
+    [[nodiscard]] bool is_open() const { return data_ != nullptr; }
+
+    [[nodiscard]] const DRaFTSignalRecord* find(std::string_view signal) const;
+    [[nodiscard]] const void* values(const DRaFTSignalRecord& record) const { return data_ + record.data_offset; }
+    [[nodiscard]] const uint64_t* shape(const DRaFTSignalRecord& record) const { return shapes_ + record.shape_index; }
+
+private:
+    int read_index(std::string& error);
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    const uint64_t* shapes_ = nullptr;
+    std::unordered_map<std::string_view, const DRaFTSignalRecord*> index_;
+};
+
+#endif // DRaFT_SHOT_STORE_H
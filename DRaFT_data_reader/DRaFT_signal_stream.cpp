@@ -0,0 +1,256 @@
+#include "DRaFT_signal_stream.h"
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include "nlohmann/json.hpp"
+
+namespace {
+
+/**
+ * SAX handler keeping only the requested signal (and its metadata) of a DRaFT shot object
+ *
+ * Every other top-level value is tokenised and dropped. Parsing stops as soon as everything requested
+ * has been read, so later signals are not even tokenised. The signal must be a number or a
+ * rectangular (nested) array of numbers.
+ */
+class SignalExtractor {
+public:
+    SignalExtractor(const std::string& signal, DRaFTStreamFields fields, DRaFTStreamedSignal& result)
+        : signal_{signal}, type_key_{signal + "_type"}, rank_key_{signal + "_rank"}, fields_{fields},
+          result_{result} {}
+
+    bool null() { return other_value("null"); }
+    bool boolean(bool /*val*/) { return other_value("boolean"); }
+    bool number_integer(nlohmann::json::number_integer_t val) { return number(static_cast<double>(val)); }
+    bool number_unsigned(nlohmann::json::number_unsigned_t val) { return number(static_cast<double>(val)); }
+    bool number_float(nlohmann::json::number_float_t val, const std::string& /*unused*/) { return number(val); }
+    bool binary(nlohmann::json::binary_t& /*val*/) { return other_value("binary"); }
+
+    bool string(std::string& val)
+    {
+        if (depth_ == 1 && target_ == Target::TYPE) {
+            result_.type = std::move(val);
+            type_found_ = true;
+            return finish_value();
+        }
+        return other_value("string");
+    }
+
+    bool start_object(std::size_t /*elements*/)
+    {
+        if (depth_ == 0) {
+            ++depth_;
+            return true;
+        }
+        if ((depth_ == 1 && target_ != Target::NONE) || signal_depth_ > 0) {
+            return fail("unexpected object");
+        }
+        ++depth_;
+        return true;
+    }
+
+    bool end_object()
+    {
+        --depth_;
+        return true;
+    }
+
+    bool key(std::string& val)
+    {
+        if (depth_ != 1) {
+            return true;
+        }
+        if (val == signal_ && !signal_found_) {
+            target_ = Target::SIGNAL;
+        } else if (fields_ == DRaFTStreamFields::VALUES_AND_METADATA && val == type_key_ && !type_found_) {
+            target_ = Target::TYPE;
+        } else if (fields_ == DRaFTStreamFields::VALUES_AND_METADATA && val == rank_key_ && !rank_found_) {
+            target_ = Target::RANK;
+        } else {
+            target_ = Target::NONE;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t /*elements*/)
+    {
+        if (depth_ == 0) {
+            return fail("not a DRaFT shot file");
+        }
+        const bool signal_root = depth_ == 1 && target_ == Target::SIGNAL;
+        if (depth_ == 1 && !signal_root && target_ != Target::NONE) {
+            return fail("unexpected array");
+        }
+        ++depth_;
+        if (!signal_root && signal_depth_ == 0) {
+            return true;
+        }
+        if (signal_depth_ > 0) {
+            ++counts_.back();
+        }
+        if (leaf_level_ >= 0 && signal_depth_ >= static_cast<size_t>(leaf_level_)) {
+            return fail("ragged array");
+        }
+        counts_.push_back(0);
+        ++signal_depth_;
+        return true;
+    }
+
+    bool end_array()
+    {
+        --depth_;
+        if (signal_depth_ == 0) {
+            return true;
+        }
+        const size_t level = signal_depth_ - 1;
+        const size_t length = counts_.back();
+        counts_.pop_back();
+        if (result_.shape.size() <= level) {
+            result_.shape.resize(level + 1, unset_length);
+        }
+        if (result_.shape[level] == unset_length) {
+            result_.shape[level] = length;
+        } else if (result_.shape[level] != length) {
+            return fail("ragged array");
+        }
+        if (--signal_depth_ > 0) {
+            return true;
+        }
+        if (leaf_level_ >= 0 && static_cast<size_t>(leaf_level_) != result_.shape.size()) {
+            return fail("ragged array");
+        }
+        signal_found_ = true;
+        return finish_value();
+    }
+
+    bool parse_error(std::size_t /*position*/, const std::string& /*last_token*/,
+                     const nlohmann::json::exception& ex)
+    {
+        return fail(ex.what());
+    }
+
+    [[nodiscard]] bool complete() const
+    {
+        return signal_found_ && (fields_ != DRaFTStreamFields::VALUES_AND_METADATA || (type_found_ && rank_found_));
+    }
+    [[nodiscard]] bool stopped() const { return stopped_; }
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+private:
+    enum class Target { NONE, SIGNAL, TYPE, RANK };
+    static constexpr size_t unset_length = std::numeric_limits<size_t>::max();
+
+    bool number(double val)
+    {
+        if (depth_ == 1 && target_ == Target::RANK) {
+            result_.rank = static_cast<int>(val);
+            rank_found_ = true;
+            return finish_value();
+        }
+        if (depth_ == 1 && target_ == Target::SIGNAL) {
+            // Scalar signal
+            store(val);
+            signal_found_ = true;
+            return finish_value();
+        }
+        if (depth_ == 1 && target_ == Target::TYPE) {
+            return fail("unexpected number");
+        }
+        if (signal_depth_ == 0) {
+            return depth_ != 0 || fail("not a DRaFT shot file");
+        }
+        if (leaf_level_ < 0) {
+            leaf_level_ = static_cast<int>(signal_depth_);
+        } else if (leaf_level_ != static_cast<int>(signal_depth_)) {
+            return fail("ragged array");
+        }
+        ++counts_.back();
+        store(val);
+        return true;
+    }
+
+    void store(double val)
+    {
+        if (fields_ != DRaFTStreamFields::SHAPE) {
+            result_.values.push_back(val);
+        }
+    }
+
+    bool other_value(const char* kind)
+    {
+        if (depth_ == 0 || signal_depth_ > 0 || (depth_ == 1 && target_ != Target::NONE)) {
+            return fail(std::string{"unexpected "} + kind);
+        }
+        return true;
+    }
+
+    // A requested top-level value has been read, stop once nothing else is needed
+    bool finish_value()
+    {
+        target_ = Target::NONE;
+        if (complete()) {
+            stopped_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool fail(std::string error)
+    {
+        error_ = std::move(error);
+        return false;
+    }
+
+    const std::string& signal_;
+    const std::string type_key_;
+    const std::string rank_key_;
+    const DRaFTStreamFields fields_;
+    DRaFTStreamedSignal& result_;
+
+    size_t depth_ = 0;
+    Target target_ = Target::NONE;
+    // Open arrays of the signal and their element counts so far
+    size_t signal_depth_ = 0;
+    std::vector<size_t> counts_;
+    // Array depth of the signal values, -1 until the first value
+    int leaf_level_ = -1;
+    bool signal_found_ = false;
+    bool type_found_ = false;
+    bool rank_found_ = false;
+    bool stopped_ = false;
+    std::string error_;
+};
+
+} // namespace
+
+/**
+ * Extract one signal of a DRaFT <shot>.json file with the SAX parser
+ *
+ * Memory is bounded by the size of the signal rather than the shot, and parsing stops once the signal
+ * (and its metadata if requested) has been read.
+ *
+ * @return 0 on success, error describes the failure otherwise
+ */
+int stream_DRaFT_signal(const std::string& json_path, const std::string& signal, DRaFTStreamFields fields,
+                        DRaFTStreamedSignal& result, std::string& error)
+{
+    result = DRaFTStreamedSignal{};
+    std::ifstream json_file(json_path, std::ios::binary);
+    if (!json_file) {
+        error = "cannot open " + json_path;
+        return 1;
+    }
+
+    SignalExtractor extractor{signal, fields, result};
+    nlohmann::json::sax_parse(json_file, &extractor);
+    if (!extractor.error().empty()) {
+        error = json_path + ": " + signal + ": " + extractor.error();
+        return 1;
+    }
+    if (!extractor.stopped() && !extractor.complete()) {
+        error = json_path + ": " + signal + " (or its _type/_rank) not found";
+        return 1;
+    }
+    return 0;
+}
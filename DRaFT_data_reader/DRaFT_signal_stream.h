@@ -0,0 +1,31 @@
+#ifndef DRaFT_SIGNAL_STREAM_H
+#define DRaFT_SIGNAL_STREAM_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * One signal of a DRaFT <shot>.json file, extracted without building the document
+ *
+ * Values are decoded as double, exact for every DRaFT element type (int, float, double), and
+ * converted to the signal type once by the caller. type and rank are only filled when requested.
+ */
+struct DRaFTStreamedSignal {
+    std::vector<double> values;
+    // Row-major lengths, empty for a scalar
+    std::vector<size_t> shape;
+    std::string type;
+    int rank{0};
+};
+
+enum class DRaFTStreamFields {
+    VALUES,             // signal values and shape
+    SHAPE,              // signal shape only, values counted but not stored
+    VALUES_AND_METADATA // signal values and shape, <signal>_type and <signal>_rank
+};
+
+int stream_DRaFT_signal(const std::string& json_path, const std::string& signal, DRaFTStreamFields fields,
+                        DRaFTStreamedSignal& result, std::string& error);
+
+#endif // DRaFT_SIGNAL_STREAM_H
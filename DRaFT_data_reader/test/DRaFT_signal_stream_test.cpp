@@ -0,0 +1,194 @@
+#include "DRaFT_signal_stream.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+namespace {
+
+/**
+ * Shot file written to the temporary directory, removed with the object
+ */
+class ShotFile {
+public:
+    explicit ShotFile(const std::string& content)
+    {
+        static std::atomic<int> count{0};
+        path_ = (std::filesystem::temp_directory_path() /
+                 ("DRaFT_signal_stream_test_" + std::to_string(++count) + ".json")).string();
+        std::ofstream file(path_, std::ios::binary);
+        file << content;
+    }
+    ~ShotFile() { std::filesystem::remove(path_); }
+    ShotFile(const ShotFile&) = delete;
+    ShotFile& operator=(const ShotFile&) = delete;
+
+    [[nodiscard]] const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+/**
+ * Reference extraction through the DOM, the path the streaming reader replaces
+ *
+ * @return false if the signal is missing or not a rectangular array of numbers
+ */
+bool dom_signal(const std::string& content, const std::string& signal, DRaFTStreamedSignal& result)
+{
+    result = DRaFTStreamedSignal{};
+    const auto shot = nlohmann::json::parse(content);
+    const auto found = shot.find(signal);
+    if (found == shot.end()) {
+        return false;
+    }
+    // Row-major shape from the first element of every level
+    const nlohmann::json* node = &*found;
+    while (node->is_array()) {
+        result.shape.push_back(node->size());
+        if (node->empty()) {
+            break;
+        }
+        node = &node->front();
+    }
+    // Flatten, checking every array of a level has the same length
+    bool rectangular = true;
+    const auto flatten = [&](const auto& self, const nlohmann::json& value, size_t level) -> void {
+        if (!value.is_array()) {
+            rectangular &= value.is_number() && level == result.shape.size();
+            result.values.push_back(value.is_number() ? value.get<double>() : 0.0);
+            return;
+        }
+        rectangular &= level < result.shape.size() && value.size() == result.shape[level];
+        for (const auto& element : value) {
+            self(self, element, level + 1);
+        }
+    };
+    flatten(flatten, *found, 0);
+    if (shot.contains(signal + "_type")) {
+        result.type = shot[signal + "_type"].get<std::string>();
+    }
+    if (shot.contains(signal + "_rank")) {
+        result.rank = shot[signal + "_rank"].get<int>();
+    }
+    return rectangular;
+}
+
+void expect_same_as_dom(const std::string& content, const std::string& signal)
+{
+    DRaFTStreamedSignal expected;
+    ASSERT_TRUE(dom_signal(content, signal, expected)) << content;
+
+    const ShotFile shot_file{content};
+    DRaFTStreamedSignal streamed;
+    std::string error;
+    ASSERT_EQ(stream_DRaFT_signal(shot_file.path(), signal, DRaFTStreamFields::VALUES_AND_METADATA, streamed, error),
+              0)
+        << error;
+    EXPECT_EQ(streamed.values, expected.values);
+    EXPECT_EQ(streamed.shape, expected.shape);
+    EXPECT_EQ(streamed.type, expected.type);
+    EXPECT_EQ(streamed.rank, expected.rank);
+
+    // Shape only, the values are counted but not kept
+    ASSERT_EQ(stream_DRaFT_signal(shot_file.path(), signal, DRaFTStreamFields::SHAPE, streamed, error), 0) << error;
+    EXPECT_TRUE(streamed.values.empty());
+    EXPECT_EQ(streamed.shape, expected.shape);
+}
+
+int stream(const std::string& content, const std::string& signal, std::string& error)
+{
+    const ShotFile shot_file{content};
+    DRaFTStreamedSignal streamed;
+    return stream_DRaFT_signal(shot_file.path(), signal, DRaFTStreamFields::VALUES, streamed, error);
+}
+
+} // namespace
+
+TEST(DRaFTSignalStreamTest, Scalar)
+{
+    expect_same_as_dom(R"({"a": [1, 2], "ip": 2.5, "ip_type": "float", "ip_rank": 0})", "ip");
+    expect_same_as_dom(R"({"n": -7, "n_type": "int", "n_rank": 0})", "n");
+}
+
+TEST(DRaFTSignalStreamTest, OneDimensional)
+{
+    expect_same_as_dom(R"({"ip_type": "double", "ip": [0.5, -1, 2e3, 4], "ip_rank": 1})", "ip");
+}
+
+TEST(DRaFTSignalStreamTest, TwoDimensional)
+{
+    expect_same_as_dom(R"({"psi": [[1, 2, 3], [4, 5, 6]], "psi_type": "float", "psi_rank": 2})", "psi");
+    expect_same_as_dom(R"({"psi": [[[1], [2]], [[3], [4]], [[5], [6]]], "psi_type": "int", "psi_rank": 3})",
+                       "psi");
+}
+
+TEST(DRaFTSignalStreamTest, Empty)
+{
+    expect_same_as_dom(R"({"ip": [], "ip_type": "float", "ip_rank": 1})", "ip");
+    expect_same_as_dom(R"({"ip": [[], []], "ip_type": "float", "ip_rank": 2})", "ip");
+}
+
+// Other signals, nested objects and strings before the signal are skipped
+TEST(DRaFTSignalStreamTest, SkipsOtherValues)
+{
+    expect_same_as_dom(R"({"meta": {"ip": [9], "x": [[1], [2, 3]]}, "name": "ip", "flag": true, "none": null,
+                           "ragged": [[1], [2, 3]], "ip": [1, 2], "ip_type": "int", "ip_rank": 1})",
+                       "ip");
+}
+
+// Parsing stops once everything requested is read, later content is never tokenised
+TEST(DRaFTSignalStreamTest, StopsAfterSignal)
+{
+    std::string error;
+    EXPECT_EQ(stream(R"({"ip": [1, 2, 3], "later": [not json)", "ip", error), 0) << error;
+}
+
+// The DOM parses ragged arrays, the stream rejects them as the DOM path cannot shape them
+TEST(DRaFTSignalStreamTest, Ragged)
+{
+    for (const std::string content : {R"({"ip": [[1, 2], [3]]})", R"({"ip": [[1], [2, 3]]})",
+                                      R"({"ip": [1, [2]]})", R"({"ip": [[1], 2]})",
+                                      R"({"ip": [[[1]], [2]]})"}) {
+        DRaFTStreamedSignal expected;
+        EXPECT_FALSE(dom_signal(content, "ip", expected)) << content;
+        std::string error;
+        EXPECT_NE(stream(content, "ip", error), 0) << content;
+        EXPECT_NE(error.find("ragged"), std::string::npos) << error;
+    }
+}
+
+TEST(DRaFTSignalStreamTest, MissingSignal)
+{
+    const std::string content{R"({"ip": [1, 2], "ip_type": "int", "ip_rank": 1})"};
+    DRaFTStreamedSignal expected;
+    EXPECT_FALSE(dom_signal(content, "bt", expected));
+
+    std::string error;
+    EXPECT_NE(stream(content, "bt", error), 0);
+    EXPECT_NE(error.find("not found"), std::string::npos) << error;
+    // A key only nested inside another value is not the signal
+    EXPECT_NE(stream(R"({"meta": {"bt": 1}})", "bt", error), 0);
+}
+
+TEST(DRaFTSignalStreamTest, MissingMetadata)
+{
+    const ShotFile shot_file{R"({"ip": [1, 2], "ip_rank": 1})"};
+    DRaFTStreamedSignal streamed;
+    std::string error;
+    EXPECT_NE(stream_DRaFT_signal(shot_file.path(), "ip", DRaFTStreamFields::VALUES_AND_METADATA, streamed, error),
+              0);
+    EXPECT_EQ(stream_DRaFT_signal(shot_file.path(), "ip", DRaFTStreamFields::VALUES, streamed, error), 0) << error;
+}
+
+TEST(DRaFTSignalStreamTest, MissingFile)
+{
+    DRaFTStreamedSignal streamed;
+    std::string error;
+    EXPECT_NE(stream_DRaFT_signal("/nonexistent/shot.json", "ip", DRaFTStreamFields::VALUES, streamed, error), 0);
+    EXPECT_FALSE(error.empty());
+}
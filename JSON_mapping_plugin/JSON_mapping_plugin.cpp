@@ -18,65 +18,23 @@
  *--------------------------------------------------------------*/
 #include "JSON_mapping_plugin.h"
 #include "handlers/mapping_handler.hpp"
+#include "handlers/result_cache.hpp"
 #include "map_types/base_entry.hpp"
+#include "utils/getmany_result.hpp"
+#include "utils/ids_path.hpp"
+#include "utils/logger.hpp"
+#include "utils/worker_pool.hpp"
 
-#include <boost/algorithm/string.hpp>
+#include <atomic>
 #include <clientserver/initStructs.h>
 #include <clientserver/stringUtils.h>
-#include <fstream>
+#include <memory>
 #include <server/getServerEnvironment.h>
+#include <string_view>
+#include <structures/struct.h>
+#include <vector>
 
-namespace JSONMapping {
-
-enum class JPLogLevel { DEBUG, INFO, WARNING, ERROR };
-
-/**
- * @brief Temporary logging function for JSON_mapping_plugin, outputs
- * to UDA_HOME/etc/
- *
- * @param log_level The JPLogLevel (INFO, WARNING, ERROR, DEBUG)
- * @param log_msg The message to be logged
- * @return
- */
-int JPLog(JPLogLevel log_level, std::string_view log_msg) {
-
-    const ENVIRONMENT* environment = getServerEnvironment();
-
-    std::string log_file_name =
-        std::string{environment->logdir} + "/JSON_plugin.log";
-    std::ofstream jp_log_file;
-    jp_log_file.open(log_file_name, std::ios_base::out | std::ios_base::app);
-    std::time_t time_now =
-        std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    const auto timestamp =
-        std::put_time(std::gmtime(&time_now), "%Y-%m-%d:%H:%M:%S");
-    if (!jp_log_file) {
-        return 1;
-    }
-
-    switch (log_level) {
-    case JPLogLevel::DEBUG:
-        jp_log_file << timestamp << ":DEBUG - ";
-        break;
-    case JPLogLevel::INFO:
-        jp_log_file << timestamp << ":INFO - ";
-        break;
-    case JPLogLevel::WARNING:
-        jp_log_file << timestamp << ":WARNING - ";
-        break;
-    case JPLogLevel::ERROR:
-        jp_log_file << timestamp << ":ERROR - ";
-        break;
-    default:
-        jp_log_file << "LOG_LEVEL NOT DEFINED";
-    }
-    jp_log_file << log_msg << std::endl;
-    jp_log_file.close();
-
-    return 0;
-};
-
-}; // namespace JSONMapping
+using JMP::logging::LogLevel;
 
 /**
  * @class JSONMappingPlugin
@@ -93,6 +51,13 @@ int JPLog(JPLogLevel log_level, std::string_view log_msg) {
 class JSONMappingPlugin {
 
   public:
+    // Queued prefetches are dropped rather than run at exit
+    ~JSONMappingPlugin() {
+        // Queued prefetches are dropped, a running one finishes before the
+        // caches and mappings it uses are destroyed
+        ++m_prefetch_generation;
+        m_prefetch_pool.reset();
+    }
     int init(IDAM_PLUGIN_INTERFACE* plugin_interface);
     int reset(IDAM_PLUGIN_INTERFACE* plugin_interface);
     int help(IDAM_PLUGIN_INTERFACE* plugin_interface);
@@ -101,12 +66,36 @@ class JSONMappingPlugin {
     int default_method(IDAM_PLUGIN_INTERFACE* plugin_interface);
     int max_interface_version(IDAM_PLUGIN_INTERFACE* plugin_interface);
     int get(IDAM_PLUGIN_INTERFACE* plugin_interface);
+    int getmany(IDAM_PLUGIN_INTERFACE* plugin_interface);
+    int prefetch(IDAM_PLUGIN_INTERFACE* plugin_interface);
+    int cache_stats(IDAM_PLUGIN_INTERFACE* plugin_interface);
 
   private:
     bool m_init = false;
+    // Mapped results of previous requests, declared first as the mapping
+    // reload listener invalidates it until the handler is destroyed
+    JMP::cache::ResultCache m_result_cache;
     // Loads, controls, stores mapping file lifetime
     MappingHandler m_mapping_handler;
+    // Per-request sub-request memo budget
+    size_t m_memo_bytes{0};
+    // Raw source results fetched ahead of requests by prefetch
+    JMP::cache::ResultCache m_prefetch_cache;
+    // Incremented by reset, queued prefetches of an older generation are
+    // dropped
+    std::atomic<uint64_t> m_prefetch_generation{0};
+    // Background prefetch workers, joined by the destructor
+    std::unique_ptr<JMP::concurrency::WorkerPool> m_prefetch_pool;
     SignalType deduc_sig_type(std::string_view element_back_str);
+
+    // Request copy of one IDS's globals, indices added
+    struct RequestGlobals {
+        IDSMappingsPtr mappings;
+        nlohmann::json globals;
+    };
+    int map_element(IDAM_PLUGIN_INTERFACE* plugin_interface,
+                    std::string_view element, const RequestContext& request,
+                    RequestGlobals& request_globals);
 };
 
 /**
@@ -114,6 +103,9 @@ class JSONMappingPlugin {
  *
  * Set mapping directory and load mapping files into mapping_handler
  * RAISE_PLUGIN_ERROR if JSON mapping file location is not set
+ * JSON_MAPPING_LOAD_MODE=LAZY defers loading each IDS to its first request
+ * JSON_MAPPING_WATCH=1 reloads changed mapping files in the background
+ * JSON_MAPPING_PREFETCH_THREADS sizes the background prefetch pool
  *
  * @param plugin_interface Top-level UDA plugin interface
  * @return errorcode UDA convention to return int errorcode
@@ -126,24 +118,96 @@ int JSONMappingPlugin::init(IDAM_PLUGIN_INTERFACE* plugin_interface) {
         STR_IEQUALS(request_data->function, "initialise")) {
         reset(plugin_interface);
     }
+    // Configured once, every request calls init and the mapping watcher
+    // thread reads the handler configuration concurrently
+    if (m_init) {
+        return 0;
+    }
 
-    std::string map_dir = getenv("JSON_MAPPING_DIR");
-    if (!map_dir.empty()) {
+    // Buffered plugin log in the UDA log directory, level threshold from
+    // JSON_MAPPING_LOG_LEVEL (DEBUG, INFO (default), WARNING, ERROR, NONE)
+    auto& logger = JMP::logging::Logger::instance();
+    const char* log_level = getenv("JSON_MAPPING_LOG_LEVEL");
+    logger.set_level(log_level != nullptr
+                         ? JMP::logging::parse_level(log_level, LogLevel::INFO)
+                         : LogLevel::INFO);
+    const ENVIRONMENT* environment = getServerEnvironment();
+    logger.open(std::string{environment->logdir} + "/JSON_plugin.log");
+
+    // A precompiled mapping bundle (JSON_MAPPING_BUNDLE) takes precedence
+    // over the JSON mapping directory
+    const char* map_dir = getenv("JSON_MAPPING_DIR");
+    const char* bundle_path = getenv("JSON_MAPPING_BUNDLE");
+    if (bundle_path != nullptr && bundle_path[0] != '\0') {
+        m_mapping_handler.set_bundle_path(bundle_path);
+    } else if (map_dir != nullptr && map_dir[0] != '\0') {
         m_mapping_handler.set_map_dir(map_dir);
     } else {
-        JSONMapping::JPLog(
-            JSONMapping::JPLogLevel::ERROR,
+        JMP::logging::log(
+            LogLevel::ERROR,
             "JSONMappingPlugin::init: - JSON mapping locations not set");
         RAISE_PLUGIN_ERROR(
             "JSONMappingPlugin::init: - JSON mapping locations not set");
     }
+    // Optional, load all IDS mappings on init (EAGER, default) or each IDS on
+    // first request (LAZY)
+    const char* load_mode = getenv("JSON_MAPPING_LOAD_MODE");
+    if (load_mode != nullptr && STR_IEQUALS(load_mode, "LAZY")) {
+        m_mapping_handler.set_load_mode(LoadMode::LAZY);
+    } else {
+        m_mapping_handler.set_load_mode(LoadMode::EAGER);
+    }
+    // Optional, watch the mapping files and reload changed IDSs in the
+    // background, cached results of a reloaded IDS are dropped
+    const char* watch = getenv("JSON_MAPPING_WATCH");
+    m_mapping_handler.set_watch(watch != nullptr &&
+                                (STR_IEQUALS(watch, "1") ||
+                                 STR_IEQUALS(watch, "ON") ||
+                                 STR_IEQUALS(watch, "TRUE")));
+    m_mapping_handler.set_reload_listener([this](std::string_view ids) {
+        m_result_cache.erase_prefix(std::string{ids} + "/");
+    });
     m_mapping_handler.init();
 
+    // Result cache budget (MB, default 256, 0 disables) and entry time to
+    // live (seconds, default 600, 0 never expires)
+    const char* cache_mb = getenv("JSON_MAPPING_CACHE_MB");
+    const char* cache_ttl = getenv("JSON_MAPPING_CACHE_TTL");
+    const size_t cache_bytes =
+        (cache_mb != nullptr ? std::stoul(cache_mb) : 256) * 1024 * 1024;
+    m_result_cache.configure(
+        cache_bytes,
+        std::chrono::seconds{cache_ttl != nullptr ? std::stol(cache_ttl)
+                                                  : 600});
+    // Per-request sub-request memo budget (MB, default 512, 0 disables)
+    const char* memo_mb = getenv("JSON_MAPPING_MEMO_MB");
+    m_memo_bytes =
+        (memo_mb != nullptr ? std::stoul(memo_mb) : 512) * 1024 * 1024;
+    // Prefetched source results budget (MB, default 256, 0 disables), same
+    // time to live as the result cache
+    const char* prefetch_mb = getenv("JSON_MAPPING_PREFETCH_MB");
+    m_prefetch_cache.configure(
+        (prefetch_mb != nullptr ? std::stoul(prefetch_mb) : 256) * 1024 *
+            1024,
+        std::chrono::seconds{cache_ttl != nullptr ? std::stol(cache_ttl)
+                                                  : 600});
+    // Prefetch worker threads (default 1, 0 prefetches within the call)
+    if (m_prefetch_pool == nullptr) {
+        const char* prefetch_threads = getenv("JSON_MAPPING_PREFETCH_THREADS");
+        m_prefetch_pool = std::make_unique<JMP::concurrency::WorkerPool>(
+            prefetch_threads != nullptr
+                ? std::strtoul(prefetch_threads, nullptr, 10)
+                : 1);
+    }
+    m_init = true;
+
     return 0;
 }
 
 /**
- * @brief
+ * @brief Reset the plugin, mappings are dropped (reread on the next init),
+ * queued prefetches cancelled, buffered log messages are written and the log
+ * file closed
  *
  * @param plugin_interface Top-level UDA plugin interface
  * @return errorcode UDA convention to return int errorcode
@@ -152,6 +216,11 @@ int JSONMappingPlugin::init(IDAM_PLUGIN_INTERFACE* plugin_interface) {
 int JSONMappingPlugin::reset(IDAM_PLUGIN_INTERFACE* plugin_interface) {
     if (m_init) {
         // Free Heap & reset counters if initialised
+        m_mapping_handler.reset();
+        ++m_prefetch_generation;
+        m_result_cache.clear();
+        m_prefetch_cache.clear();
+        JMP::logging::Logger::instance().close();
         m_init = false;
     }
     return 0;
@@ -210,72 +279,372 @@ int JSONMappingPlugin::get(IDAM_PLUGIN_INTERFACE* plugin_interface) {
     FIND_STRING_VALUE(request_data->nameValueList, experiment);
     const char* element{nullptr};
     FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, element);
-    std::string ids_path{element};
 
-    std::deque<std::string> split_elem_vec;
-    boost::split(split_elem_vec, ids_path, boost::is_any_of("/"));
-    if (split_elem_vec.empty()) {
-        JSONMapping::JPLog(
-            JSONMapping::JPLogLevel::ERROR,
+    // Find/Set request data such as host, port, shot, indices,
+    // immutable for the rest of the request
+    RequestContext request;
+    const int err = make_request_context(&request_data->nameValueList,
+                                         SignalType::DEFAULT, request);
+    if (err) {
+        return err;
+    }
+    // Sub-request memo attached by map_element, only for entries with
+    // dependency fetches
+    request.prefetched = &m_prefetch_cache;
+
+    RequestGlobals request_globals;
+    return map_element(plugin_interface, element, request, request_globals);
+}
+
+/**
+ * @brief Batched get, map a list of IDS elements sharing one shot and
+ * indices set in a single plugin call
+ *
+ * eg. getmany(elements=magnetics/flux_loop/#/flux/data;magnetics/flux_loop/
+ * #/flux/time, shot=..., indices=..., IDS_version=...)
+ *
+ * Returns a JMP_GETMANY compound structure holding one JMP_GETMANY_ELEMENT
+ * (path, status, message, type, shape, data) per requested element, in
+ * request order. A failing element, including one whose mapping throws,
+ * sets its status and message and does not fail the batch.
+ *
+ * @param plugin_interface Top-level UDA plugin interface
+ * @return errorcode UDA convention to return int errorcode
+ * 0 success, !0 failure
+ */
+int JSONMappingPlugin::getmany(IDAM_PLUGIN_INTERFACE* plugin_interface) {
+
+    DATA_BLOCK* data_block = plugin_interface->data_block;
+    REQUEST_DATA* request_data = plugin_interface->request_data;
+
+    initDataBlock(data_block);
+
+    const char* IDS_version{nullptr};
+    const char* experiment{nullptr};
+    FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, IDS_version);
+    FIND_STRING_VALUE(request_data->nameValueList, experiment);
+    const char* elements{nullptr};
+    FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, elements);
+
+    RequestContext request;
+    const int err = make_request_context(&request_data->nameValueList,
+                                         SignalType::DEFAULT, request);
+    if (err) {
+        return err;
+    }
+    // Sub-requests fetched once for the whole batch, eg. every channel of
+    // a slice over one 2D signal
+    JMP::cache::ResultCache memo;
+    memo.configure(m_memo_bytes, std::chrono::seconds{0});
+    request.memo = &memo;
+    request.prefetched = &m_prefetch_cache;
+
+    // ';' separated element paths, views into the request string
+    std::vector<std::string_view> element_paths;
+    std::string_view elements_view{elements};
+    while (!elements_view.empty()) {
+        const auto sep = elements_view.find(';');
+        const auto path = elements_view.substr(0, sep);
+        if (!path.empty()) {
+            element_paths.push_back(path);
+        }
+        if (sep == std::string_view::npos) {
+            break;
+        }
+        elements_view.remove_prefix(sep + 1);
+    }
+    if (element_paths.empty()) {
+        RAISE_PLUGIN_ERROR("JSONMappingPlugin::getmany: - no elements given");
+    }
+
+    JMP::getmany::define_types(plugin_interface->userdefinedtypelist);
+    const auto count = static_cast<int>(element_paths.size());
+    auto* results =
+        JMP::getmany::new_elements(count, plugin_interface->logmalloclist);
+
+    // Each element is mapped into its own block, the globals copy is
+    // shared by consecutive elements of the same IDS
+    RequestGlobals request_globals;
+    for (int i = 0; i < count; ++i) {
+        DATA_BLOCK element_block;
+        initDataBlock(&element_block);
+        plugin_interface->data_block = &element_block;
+        int status{1};
+        std::string message;
+        try {
+            status = map_element(plugin_interface, element_paths[i], request,
+                                 request_globals);
+        } catch (const std::exception& ex) {
+            // eg. template rendering with a missing index, the element
+            // fails and the batch carries on
+            message = ex.what();
+            JMP::logging::log(LogLevel::WARNING,
+                              "JSONMappingPlugin::getmany: - " +
+                                  std::string{element_paths[i]} + ": " +
+                                  message);
+        } catch (...) {
+            message = "unknown exception";
+        }
+        plugin_interface->data_block = data_block;
+        if (status != 0 && message.empty()) {
+            message = "mapping failed";
+        }
+        JMP::getmany::take_element(results[i], element_paths[i], status,
+                                   message, &element_block,
+                                   plugin_interface->logmalloclist);
+    }
+
+    return JMP::getmany::set_return_result(plugin_interface, results, count);
+}
+
+/**
+ * @brief Fetch the source signals of an IDS ahead of the requests mapping
+ * them
+ *
+ * eg. prefetch(ids=magnetics, shot=..., IDS_version=...[, indices=...])
+ *
+ * The source request of every PLUGIN entry of the IDS is queued on the
+ * prefetch pool and the call returns at once, with the number of requests
+ * queued. Results are kept in the prefetch cache and used by later
+ * get/getmany calls issuing the same source request, the mapping itself
+ * (scale, offset, slicing, expressions) is still evaluated per request.
+ * Entries whose templates need IDS indices are only prefetched when
+ * indices are given, and for those indices. Source plugins are not thread
+ * safe, a prefetch waits for any source call of the foreground request and
+ * holds off the next one until it returns.
+ *
+ * @param plugin_interface Top-level UDA plugin interface
+ * @return errorcode UDA convention to return int errorcode
+ * 0 success, !0 failure
+ */
+int JSONMappingPlugin::prefetch(IDAM_PLUGIN_INTERFACE* plugin_interface) {
+
+    DATA_BLOCK* data_block = plugin_interface->data_block;
+    REQUEST_DATA* request_data = plugin_interface->request_data;
+
+    initDataBlock(data_block);
+
+    const char* IDS_version{nullptr};
+    FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, IDS_version);
+    const char* ids{nullptr};
+    FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, ids);
+
+    // Shared by every queued fetch, outlives this call
+    struct PrefetchBatch {
+        IDSMappingsPtr mappings;
+        nlohmann::json globals;
+        RequestContext request;
+        IDAM_PLUGIN_INTERFACE interface;
+        uint64_t generation;
+    };
+    auto batch = std::make_shared<PrefetchBatch>();
+    // Unlike get, dtype is not needed and indices are optional
+    int shot{0};
+    FIND_REQUIRED_INT_VALUE(request_data->nameValueList, shot);
+    int* indices{nullptr};
+    size_t nindices{0};
+    FIND_INT_ARRAY(request_data->nameValueList, indices);
+    batch->request.host = "uda2.hpc.l";
+    batch->request.port = 56565;
+    batch->request.shot = shot;
+    if (!(nindices == 1 && indices[0] == -1)) {
+        // IMAS is 1-based, mapped sources zero-based
+        for (size_t i = 0; i < nindices; ++i) {
+            batch->request.indices.push_back(indices[i] - 1);
+        }
+    }
+    if (!m_prefetch_cache.enabled()) {
+        RAISE_PLUGIN_ERROR(
+            "JSONMappingPlugin::prefetch: - prefetch cache disabled");
+    }
+
+    batch->mappings = m_mapping_handler.read_mappings(ids);
+    if (batch->mappings->entries.empty()) {
+        RAISE_PLUGIN_ERROR("JSONMappingPlugin::prefetch:"
+                           " - JSON mapping not loaded, no map entries");
+    }
+    batch->globals = batch->mappings->globals;
+    batch->globals["indices"] = batch->request.indices;
+    batch->interface = *plugin_interface;
+    batch->generation = m_prefetch_generation;
+
+    const auto& map_entries = batch->mappings->entries.of_type<MapEntry>();
+    for (const auto& map_entry : map_entries) {
+        m_prefetch_pool->submit([this, batch, entry = &map_entry]() {
+            if (batch->generation != m_prefetch_generation) {
+                return 0;
+            }
+            // The request this was queued by has ended, fetch with lists
+            // and request data owned by the task
+            LOGMALLOCLIST logmalloclist;
+            initLogMallocList(&logmalloclist);
+            USERDEFINEDTYPELIST userdefinedtypelist;
+            initUserDefinedTypeList(&userdefinedtypelist);
+            REQUEST_DATA task_request_data;
+            initRequestData(&task_request_data);
+            IDAM_PLUGIN_INTERFACE task_interface{batch->interface};
+            task_interface.request_data = &task_request_data;
+            task_interface.logmalloclist = &logmalloclist;
+            task_interface.userdefinedtypelist = &userdefinedtypelist;
+
+            int task_err{1};
+            try {
+                task_err = entry->prefetch(&task_interface, batch->globals,
+                                           batch->request, m_prefetch_cache);
+            } catch (const std::exception& ex) {
+                // eg. templated on indices not given
+                JMP::logging::log(LogLevel::DEBUG,
+                                  std::string{"JSONMappingPlugin::prefetch: - "
+                                              "entry skipped, "} +
+                                      ex.what());
+            }
+            freeMallocLogList(&logmalloclist);
+            freeUserDefinedTypeList(&userdefinedtypelist);
+            return task_err;
+        });
+    }
+
+    JMP::logging::log(LogLevel::INFO,
+                      "JSONMappingPlugin::prefetch: - " +
+                          std::to_string(map_entries.size()) +
+                          " source requests queued for " + ids);
+    return setReturnDataIntScalar(data_block,
+                                  static_cast<int>(map_entries.size()),
+                                  "Source requests queued");
+}
+
+/**
+ * @brief Map a single IDS element into plugin_interface->data_block
+ *
+ * @param plugin_interface Top-level UDA plugin interface
+ * @param element full IDS element path, eg. magnetics/coil/#/current
+ * @param request request context shared by all elements of the request,
+ * the signal type is deduced per element
+ * @param request_globals IDS globals copy with the request indices added,
+ * rebuilt only when the IDS changes
+ * @return errorcode UDA convention to return int errorcode
+ * 0 success, !0 failure
+ */
+int JSONMappingPlugin::map_element(IDAM_PLUGIN_INTERFACE* plugin_interface,
+                                   std::string_view element,
+                                   const RequestContext& request,
+                                   RequestGlobals& request_globals) {
+
+    // Views into element, no allocation
+    // magnetics/coil/#/current -> magnetics, coil/#/current, current
+    const auto ids_path = JMP::ids_path::parse(element);
+    if (ids_path.ids.empty()) {
+        JMP::logging::log(
+            LogLevel::ERROR,
             "JSONMappingPlugin::get: - IDS path could not be split");
         RAISE_PLUGIN_ERROR(
             "JSONMappingPlugin::get: - IDS path could not be split");
     }
 
-    // Use first hash of the IDS path as the IDS name
-    std::string current_ids{split_elem_vec.front()};
-
-    // Load mappings based off current_ids name
-    // Returns a reference to IDS map objects and corresponding globals
-    // Mapping object lifetime owned by mapping_handler
-    const auto& [ids_attrs_map, map_entries] =
-        m_mapping_handler.read_mappings(current_ids);
+    // Load mappings based off the IDS name (first hash of the IDS path)
+    // Returns a snapshot of the IDS map objects and corresponding globals,
+    // kept alive by this request across a background reload
+    uint64_t mappings_generation{0};
+    const auto ids_mappings =
+        m_mapping_handler.read_mappings(ids_path.ids, mappings_generation);
+    const auto& map_entries = ids_mappings->entries;
 
     if (map_entries.empty()) {
-        JSONMapping::JPLog(JSONMapping::JPLogLevel::ERROR,
-                           "JSONMappingPlugin::get:"
-                           " - JSON mapping not loaded, no map entries");
+        JMP::logging::log(LogLevel::ERROR,
+                          "JSONMappingPlugin::get:"
+                          " - JSON mapping not loaded, no map entries");
         RAISE_PLUGIN_ERROR("JSONMappingPlugin::get:"
                            " - JSON mapping not loaded, no map entries");
     }
 
-    // Remove IDS name from path and rejoin for hash map key
+    // IDS name removed from path for the mapping key
     // magnetics/coil/#/current -> coil/#/current
-    split_elem_vec.pop_front();
-    std::string map_path = boost::algorithm::join(split_elem_vec, "/");
-    JSONMapping::JPLog(JSONMapping::JPLogLevel::INFO, map_path);
+    JMP::logging::log(LogLevel::INFO, ids_path.map_path);
 
     // Deduce signal_type
-    const auto sig_type = deduc_sig_type(split_elem_vec.back());
+    const auto sig_type = deduc_sig_type(ids_path.suffix);
     if (sig_type == SignalType::INVALID) {
         return 1; // Don't throw, go gentle into that good night
     }
 
-    if (!map_entries.count(map_path)) { // implicit conversion
-        JSONMapping::JPLog(JSONMapping::JPLogLevel::WARNING,
-                           "JSONMappingPlugin::get: - "
-                           "IDS path not found in JSON mapping file");
+    // Single hashed lookup per candidate path
+    const Mapping* map_entry = map_entries.find(ids_path.map_path);
+    if (map_entry == nullptr) {
+        JMP::logging::log(LogLevel::WARNING,
+                          "JSONMappingPlugin::get: - "
+                          "IDS path not found in JSON mapping file");
         if (sig_type == SignalType::TIME or sig_type == SignalType::DATA) {
-            split_elem_vec.pop_back();
-            map_path = boost::algorithm::join(split_elem_vec, "/");
-            if (!map_entries.count(map_path)) { // implicit conversion
-                return 1;                       // No mapping found, don't throw
-            }
+            // Fallback to the parent node, eg. coil/#/current/data ->
+            // coil/#/current, a view of the same element buffer
+            map_entry = map_entries.find(ids_path.parent);
+        }
+        if (map_entry == nullptr) {
+            return 1; // No mapping found, don't throw
         }
     }
 
-    // TODO: Rethink request data store when parsing NameValueList
-    // Find/Set request data such as host, port, shot,
-    // indices + signal type
-    map_entries[map_path]->set_current_request_data(
-        &request_data->nameValueList);
-    map_entries[map_path]->set_sig_type(sig_type);
-    // Add request indices to globals
-    ids_attrs_map["indices"] = map_entries[map_path]->get_current_indices();
+    // Add request indices to a request copy of the globals, shared
+    // IDS globals are left untouched
+    if (request_globals.mappings != ids_mappings) {
+        request_globals.mappings = ids_mappings;
+        request_globals.globals = ids_mappings->globals;
+        request_globals.globals["indices"] = request.indices;
+    }
+
+    auto element_request = request.with_sig_type(sig_type);
+    // Dependency fetches (SLICE, EXPR, DIMENSION) can repeat a sub-request
+    // within one element, a plain MapEntry fetches its source once and is
+    // not copied into a memo
+    JMP::cache::ResultCache element_memo;
+    if (element_request.memo == nullptr &&
+        dynamic_cast<const MapEntry*>(map_entry) == nullptr) {
+        element_memo.configure(m_memo_bytes, std::chrono::seconds{0});
+        element_request.memo = &element_memo;
+    }
+    std::string cache_key;
+    if (m_result_cache.enabled()) {
+        cache_key = JMP::cache::ResultCache::make_key(element, element_request);
+        if (m_result_cache.restore(cache_key, plugin_interface->data_block)) {
+            return 0;
+        }
+    }
 
     // For mapping object perform mapping
-    return map_entries[map_path]->map(plugin_interface, map_entries,
-                                      ids_attrs_map);
+    const int err =
+        map_entry->map(plugin_interface, map_entries, request_globals.globals,
+                       element_request);
+    // Not cached if the mappings were reloaded while mapping, checked under
+    // the cache lock so a reload cannot invalidate before the store
+    if (err == 0 && m_result_cache.enabled()) {
+        m_result_cache.store(cache_key, plugin_interface->data_block, [&]() {
+            return m_mapping_handler.generation() == mappings_generation;
+        });
+    }
+    return err;
+}
+
+/**
+ * @brief Result cache counters, prefetch cache counters under "prefetch"
+ *
+ * @param plugin_interface Top-level UDA plugin interface
+ * @return errorcode UDA convention to return int errorcode
+ * 0 success, !0 failure
+ */
+int JSONMappingPlugin::cache_stats(IDAM_PLUGIN_INTERFACE* plugin_interface) {
+
+    const auto to_json = [](const JMP::cache::CacheStats& stats) {
+        return nlohmann::json{{"hits", stats.hits},
+                              {"misses", stats.misses},
+                              {"insertions", stats.insertions},
+                              {"evictions", stats.evictions},
+                              {"entries", stats.entries},
+                              {"bytes", stats.bytes}};
+    };
+    auto stats_json = to_json(m_result_cache.stats());
+    stats_json["prefetch"] = to_json(m_prefetch_cache.stats());
+    const std::string stats_str = stats_json.dump();
+    return setReturnDataString(plugin_interface->data_block, stats_str.c_str(),
+                               "JSON mapping plugin result cache counters");
 }
 
 /**
@@ -331,6 +700,14 @@ int jsonMappingPlugin(IDAM_PLUGIN_INTERFACE* plugin_interface) {
         } else if (STR_IEQUALS(plugin_func, "get")) {
             UDA_LOG(UDA_LOG_DEBUG, "calling get function \n");
             return plugin.get(plugin_interface);
+        } else if (STR_IEQUALS(plugin_func, "getmany")) {
+            UDA_LOG(UDA_LOG_DEBUG, "calling getmany function \n");
+            return plugin.getmany(plugin_interface);
+        } else if (STR_IEQUALS(plugin_func, "prefetch")) {
+            UDA_LOG(UDA_LOG_DEBUG, "calling prefetch function \n");
+            return plugin.prefetch(plugin_interface);
+        } else if (STR_IEQUALS(plugin_func, "cachestats")) {
+            return plugin.cache_stats(plugin_interface);
         } else if (STR_IEQUALS(plugin_func, "close")) {
             UDA_LOG(UDA_LOG_DEBUG, "calling close function \n");
             return 0;
@@ -0,0 +1,108 @@
+#include "handlers/map_register.hpp"
+
+/**
+ * @brief FNV-1a hash of a mapping path
+ *
+ * @param key mapping path
+ * @return uint64_t hash
+ */
+uint64_t IDSMapRegister::hash(std::string_view key) {
+    uint64_t key_hash{14695981039346656037ULL};
+    for (const char c : key) {
+        key_hash ^= static_cast<unsigned char>(c);
+        key_hash *= 1099511628211ULL;
+    }
+    return key_hash;
+}
+
+/**
+ * @brief Linear probe for a path
+ *
+ * @param key mapping path
+ * @param key_hash hash of key
+ * @return size_t slot holding the path, or the empty slot it would occupy
+ */
+size_t IDSMapRegister::probe(std::string_view key, uint64_t key_hash) const {
+
+    const size_t mask{m_index.size() - 1};
+    size_t slot{static_cast<size_t>(key_hash) & mask};
+    while (m_index[slot].id != npos) {
+        if (m_index[slot].hash == key_hash &&
+            this->key(m_index[slot].id) == key) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Grow the index to hold count paths at a load factor <= 0.5,
+ * existing ids are re-slotted using their stored hashes
+ *
+ * @param count number of paths to hold
+ */
+void IDSMapRegister::reserve_index(size_t count) {
+
+    size_t capacity{16};
+    while (capacity < 2 * count) {
+        capacity *= 2;
+    }
+    if (capacity <= m_index.size()) {
+        return;
+    }
+
+    std::vector<Slot> old_index(capacity);
+    old_index.swap(m_index);
+    const size_t mask{capacity - 1};
+    for (const auto& old_slot : old_index) {
+        if (old_slot.id == npos) {
+            continue;
+        }
+        size_t slot{static_cast<size_t>(old_slot.hash) & mask};
+        while (m_index[slot].id != npos) {
+            slot = (slot + 1) & mask;
+        }
+        m_index[slot] = old_slot;
+    }
+}
+
+IDSMapRegister::Id_t IDSMapRegister::intern(std::string_view key,
+                                            const Mapping* entry, size_t slot,
+                                            uint64_t key_hash) {
+
+    const auto id = static_cast<Id_t>(m_entries.size());
+    m_key_spans.emplace_back(static_cast<uint32_t>(m_key_chars.size()),
+                             static_cast<uint32_t>(key.size()));
+    m_key_chars.append(key);
+    m_entries.push_back(entry);
+    m_index[slot] = Slot{key_hash, id};
+    return id;
+}
+
+/**
+ * @brief Find the id of a mapping path, hashing the path once
+ *
+ * @param key mapping path
+ * @return Id_t id, npos if not registered
+ */
+IDSMapRegister::Id_t IDSMapRegister::find_id(std::string_view key) const {
+    if (m_index.empty()) {
+        return npos;
+    }
+    return m_index[probe(key, hash(key))].id;
+}
+
+const Mapping& IDSMapRegister::at(std::string_view key) const {
+    const auto* entry = find(key);
+    if (entry == nullptr) {
+        throw std::out_of_range("IDSMapRegister::at - mapping not found: " +
+                                std::string{key});
+    }
+    return *entry;
+}
+
+std::string_view IDSMapRegister::key(Id_t id) const {
+    const auto& [offset, length] = m_key_spans.at(id);
+    return std::string_view{m_key_chars}.substr(offset, length);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "map_types/base_entry.hpp"
+#include "map_types/custom_entry.hpp"
+#include "map_types/dim_entry.hpp"
+#include "map_types/expr_entry.hpp"
+#include "map_types/map_entry.hpp"
+#include "map_types/slice_entry.hpp"
+
+/**
+ * @class IDSMapRegister
+ * @brief Flat registry of all mapping entries of a single IDS
+ *
+ * Mapping paths are interned into one contiguous character buffer and given
+ * dense integer ids. An open-addressing (linear probing) index built while
+ * loading maps a path to its id with a single hash per lookup. Entries are
+ * stored by value in one arena (std::vector) per mapping type, reserved
+ * before loading so entry addresses never change.
+ */
+class IDSMapRegister {
+  public:
+    using Id_t = uint32_t;
+    static constexpr Id_t npos{std::numeric_limits<Id_t>::max()};
+
+    template <typename Entry> void reserve(size_t count);
+    template <typename Entry, typename... Args>
+    bool emplace(std::string_view key, Args&&... args);
+
+    [[nodiscard]] Id_t find_id(std::string_view key) const;
+    [[nodiscard]] const Mapping* find(std::string_view key) const {
+        const auto id = find_id(key);
+        return id == npos ? nullptr : m_entries[id];
+    }
+    [[nodiscard]] const Mapping& at(std::string_view key) const;
+    [[nodiscard]] const Mapping& at(Id_t id) const { return *m_entries.at(id); }
+    [[nodiscard]] size_t count(std::string_view key) const {
+        return find_id(key) != npos ? 1 : 0;
+    }
+    [[nodiscard]] std::string_view key(Id_t id) const;
+    [[nodiscard]] size_t size() const { return m_entries.size(); }
+    // Every entry of one mapping type, in load order
+    template <typename Entry>
+    [[nodiscard]] const std::vector<Entry>& of_type() const {
+        return std::get<std::vector<Entry>>(m_arenas);
+    }
+    [[nodiscard]] bool empty() const { return m_entries.empty(); }
+
+  private:
+    struct Slot {
+        uint64_t hash{0};
+        Id_t id{npos};
+    };
+
+    static uint64_t hash(std::string_view key);
+    [[nodiscard]] size_t probe(std::string_view key, uint64_t key_hash) const;
+    void reserve_index(size_t count);
+    Id_t intern(std::string_view key, const Mapping* entry, size_t slot,
+                uint64_t key_hash);
+
+    template <typename Entry> std::vector<Entry>& arena() {
+        return std::get<std::vector<Entry>>(m_arenas);
+    }
+
+    // Interned paths, id -> (offset, length) into m_key_chars
+    std::string m_key_chars;
+    std::vector<std::pair<uint32_t, uint32_t>> m_key_spans;
+    // id -> entry, pointing into the type arenas
+    std::vector<const Mapping*> m_entries;
+    // Open-addressing index, power of two size, load factor <= 0.5
+    std::vector<Slot> m_index;
+    std::tuple<std::vector<ValueEntry>, std::vector<MapEntry>,
+               std::vector<DimEntry>, std::vector<SliceEntry>,
+               std::vector<ExprEntry>, std::vector<CustomEntry>>
+        m_arenas;
+};
+
+/**
+ * @brief Reserve arena storage (and index capacity) for entries of one type,
+ * must be called before the first emplace of that type
+ *
+ * @tparam Entry mapping entry type
+ * @param count number of entries of this type to be loaded
+ */
+template <typename Entry> void IDSMapRegister::reserve(size_t count) {
+    auto& entries = arena<Entry>();
+    entries.reserve(entries.size() + count);
+    reserve_index(m_entries.size() + count);
+}
+
+/**
+ * @brief Construct an entry in place in its type arena and index its path
+ *
+ * @tparam Entry mapping entry type
+ * @param key mapping path, eg. coil/#/current
+ * @param args Entry constructor arguments
+ * @return true if inserted, false if the path is already registered
+ * @throw std::length_error if the arena was not reserved large enough
+ */
+template <typename Entry, typename... Args>
+bool IDSMapRegister::emplace(std::string_view key, Args&&... args) {
+
+    const auto key_hash = hash(key);
+    reserve_index(m_entries.size() + 1);
+    const auto slot = probe(key, key_hash);
+    if (m_index[slot].id != npos) {
+        return false;
+    }
+
+    auto& entries = arena<Entry>();
+    if (entries.size() == entries.capacity()) {
+        // Reallocation would invalidate the entry pointers
+        throw std::length_error("IDSMapRegister::emplace - arena not reserved");
+    }
+    entries.emplace_back(std::forward<Args>(args)...);
+    intern(key, &entries.back(), slot, key_hash);
+    return true;
+}
@@ -0,0 +1,852 @@
+#include "handlers/mapping_bundle.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <inja/inja.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace JMP::bundle {
+
+/**
+ * @class BundleCursor
+ * @brief Bounds checked sequential reader over one bundle section
+ */
+class BundleCursor {
+  public:
+    BundleCursor(const char* begin, const char* end)
+        : m_pos{begin}, m_end{end} {}
+
+    template <typename T> T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+    const char* take(uint64_t count) {
+        if (static_cast<uint64_t>(m_end - m_pos) < count) {
+            throw BundleError("truncated bundle record");
+        }
+        const char* pos = m_pos;
+        m_pos += count;
+        return pos;
+    }
+    [[nodiscard]] bool at_end() const { return m_pos == m_end; }
+
+  private:
+    const char* m_pos;
+    const char* m_end;
+};
+
+namespace {
+
+enum class ValueKind : uint8_t {
+    NONE,
+    BOOL_FALSE,
+    BOOL_TRUE,
+    INTEGER,
+    UNSIGNED,
+    FLOAT,
+    STRING,
+    INTEGER_ARRAY,
+    UNSIGNED_ARRAY,
+    FLOAT_ARRAY,
+    MSGPACK
+};
+
+// PLUGIN entry flags
+constexpr uint8_t has_offset_flag{1};
+constexpr uint8_t has_scale_flag{2};
+constexpr uint8_t promote_double_flag{4};
+
+constexpr std::pair<std::string_view, EntryType> map_type_names[]{
+    {"VALUE", EntryType::VALUE}, {"PLUGIN", EntryType::PLUGIN},
+    {"DIMENSION", EntryType::DIM}, {"SLICE", EntryType::SLICE},
+    {"EXPR", EntryType::EXPR},   {"CUSTOM", EntryType::CUSTOM}};
+
+BundleCursor section(const char* data, size_t size, uint64_t offset,
+                     uint64_t length) {
+    if (offset > size || length > size - offset) {
+        throw BundleError("bundle section out of range");
+    }
+    return {data + offset, data + offset + length};
+}
+
+nlohmann::json read_json_file(const std::string& file_path) {
+    std::ifstream file(file_path);
+    if (!file) {
+        throw BundleError("cannot open " + file_path);
+    }
+    nlohmann::json data;
+    try {
+        file >> data;
+    } catch (const nlohmann::json::exception& ex) {
+        throw BundleError(file_path + ": " + ex.what());
+    }
+    return data;
+}
+
+/**
+ * @class BundleWriter
+ * @brief Serialises IDS mappings and the version table into bundle bytes
+ */
+class BundleWriter {
+  public:
+    BundleWriter() : m_bytes(sizeof(BundleHeader), '\0') {}
+
+    [[nodiscard]] bool has_ids(const std::string& ids_name) const {
+        return m_ids_index.count(ids_name) != 0;
+    }
+    void add_ids(const std::string& ids_name, const nlohmann::json& globals,
+                 const nlohmann::json& mappings);
+    void add_version(const std::string& version,
+                     const std::vector<std::string>& ids_names);
+    std::string finish();
+
+  private:
+    template <typename T> void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void put_kind(ValueKind kind) { put(static_cast<uint8_t>(kind)); }
+    void put_string(std::string_view str) { put(intern(str)); }
+    template <typename T>
+    void put_array(ValueKind kind, const nlohmann::json& values);
+    void put_value(const nlohmann::json& value);
+    void put_entry(const EntryRecord& record);
+    void align();
+    uint32_t intern(std::string_view str);
+
+    std::string m_bytes;
+    // Interned strings, ids in insertion order
+    std::unordered_map<std::string, uint32_t> m_string_ids;
+    std::vector<const std::string*> m_strings;
+    std::vector<IDSRecord> m_ids;
+    std::unordered_map<std::string, uint32_t> m_ids_index;
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> m_versions;
+};
+
+uint32_t BundleWriter::intern(std::string_view str) {
+    const auto [string_id, inserted] = m_string_ids.try_emplace(
+        std::string{str}, static_cast<uint32_t>(m_strings.size()));
+    if (inserted) {
+        m_strings.push_back(&string_id->first);
+    }
+    return string_id->second;
+}
+
+void BundleWriter::align() {
+    m_bytes.resize((m_bytes.size() + 7) & ~static_cast<size_t>(7), '\0');
+}
+
+template <typename T>
+void BundleWriter::put_array(ValueKind kind, const nlohmann::json& values) {
+    put_kind(kind);
+    put(static_cast<uint32_t>(values.size()));
+    for (const auto& value : values) {
+        put(value.get<T>());
+    }
+}
+
+/**
+ * @brief Encode a JSON value, scalars and arrays of a single number type are
+ * stored natively, anything else as MessagePack
+ */
+void BundleWriter::put_value(const nlohmann::json& value) {
+
+    using value_t = nlohmann::json::value_t;
+    switch (value.type()) {
+    case value_t::null:
+        put_kind(ValueKind::NONE);
+        return;
+    case value_t::boolean:
+        put_kind(value.get<bool>() ? ValueKind::BOOL_TRUE
+                                   : ValueKind::BOOL_FALSE);
+        return;
+    case value_t::number_integer:
+        put_kind(ValueKind::INTEGER);
+        put(value.get<int64_t>());
+        return;
+    case value_t::number_unsigned:
+        put_kind(ValueKind::UNSIGNED);
+        put(value.get<uint64_t>());
+        return;
+    case value_t::number_float:
+        put_kind(ValueKind::FLOAT);
+        put(value.get<double>());
+        return;
+    case value_t::string:
+        put_kind(ValueKind::STRING);
+        put_string(value.get_ref<const std::string&>());
+        return;
+    case value_t::array: {
+        const auto element_type =
+            value.empty() ? value_t::null : value.front().type();
+        const bool uniform = std::all_of(
+            value.begin(), value.end(), [&](const nlohmann::json& element) {
+                return element.type() == element_type;
+            });
+        if (uniform && element_type == value_t::number_integer) {
+            put_array<int64_t>(ValueKind::INTEGER_ARRAY, value);
+            return;
+        }
+        if (uniform && element_type == value_t::number_unsigned) {
+            put_array<uint64_t>(ValueKind::UNSIGNED_ARRAY, value);
+            return;
+        }
+        if (uniform && element_type == value_t::number_float) {
+            put_array<double>(ValueKind::FLOAT_ARRAY, value);
+            return;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    const auto packed = nlohmann::json::to_msgpack(value);
+    put_kind(ValueKind::MSGPACK);
+    put(static_cast<uint32_t>(packed.size()));
+    m_bytes.append(packed.begin(), packed.end());
+}
+
+void BundleWriter::put_entry(const EntryRecord& record) {
+
+    put_string(record.key);
+    put(static_cast<uint8_t>(record.type));
+    switch (record.type) {
+    case EntryType::VALUE:
+        put_value(record.value);
+        break;
+    case EntryType::PLUGIN: {
+        put_string(record.name);
+        put(static_cast<uint32_t>(record.args.size()));
+        for (const auto& [name, arg] : record.args) {
+            put_string(name);
+            put_value(arg);
+        }
+        uint8_t flags{0};
+        flags |= record.offset ? has_offset_flag : 0;
+        flags |= record.scale ? has_scale_flag : 0;
+        flags |= record.promote_double ? promote_double_flag : 0;
+        put(flags);
+        put(record.offset.value_or(0.0f));
+        put(record.scale.value_or(1.0f));
+        break;
+    }
+    case EntryType::DIM:
+    case EntryType::CUSTOM:
+        put_string(record.name);
+        break;
+    case EntryType::SLICE:
+        put(static_cast<uint32_t>(record.slice_indices.size()));
+        for (const auto index : record.slice_indices) {
+            put_string(index);
+        }
+        put_string(record.name);
+        break;
+    case EntryType::EXPR:
+        put_string(record.name);
+        put(static_cast<uint32_t>(record.parameters.size()));
+        for (const auto& [name, signal] : record.parameters) {
+            put_string(name);
+            put_string(signal);
+        }
+        put_string(record.output_type);
+        break;
+    }
+}
+
+void BundleWriter::add_ids(const std::string& ids_name,
+                           const nlohmann::json& globals,
+                           const nlohmann::json& mappings) {
+
+    IDSRecord ids{};
+    ids.name = intern(ids_name);
+
+    const auto packed_globals = nlohmann::json::to_msgpack(globals);
+    align();
+    ids.globals_offset = m_bytes.size();
+    ids.globals_size = packed_globals.size();
+    m_bytes.append(packed_globals.begin(), packed_globals.end());
+
+    ids.entries_offset = m_bytes.size();
+    EntryRecord record;
+    for (const auto& [key, value] : mappings.items()) {
+        try {
+            if (entry_from_json(key, value, globals, record) != 0) {
+                throw BundleError("unrecognised MAP_TYPE");
+            }
+        } catch (const std::exception& ex) {
+            throw BundleError(ids_name + "/" + key + ": " + ex.what());
+        }
+        put_entry(record);
+        ++ids.type_counts[static_cast<size_t>(record.type)];
+        ++ids.entry_count;
+    }
+    ids.entries_size = m_bytes.size() - ids.entries_offset;
+
+    m_ids_index.emplace(ids_name, static_cast<uint32_t>(m_ids.size()));
+    m_ids.push_back(ids);
+}
+
+void BundleWriter::add_version(const std::string& version,
+                               const std::vector<std::string>& ids_names) {
+    std::vector<uint32_t> ids_indices;
+    for (const auto& ids_name : ids_names) {
+        ids_indices.push_back(m_ids_index.at(ids_name));
+    }
+    m_versions.emplace_back(intern(version), std::move(ids_indices));
+}
+
+/**
+ * @brief Append the string, version and IDS tables and fill in the header
+ *
+ * @return std::string complete bundle bytes
+ */
+std::string BundleWriter::finish() {
+
+    BundleHeader header{};
+    std::copy(std::begin(bundle_magic), std::end(bundle_magic), header.magic);
+    header.format_version = bundle_format_version;
+    header.byte_order = bundle_byte_order;
+
+    align();
+    header.strings_offset = m_bytes.size();
+    header.string_count = static_cast<uint32_t>(m_strings.size());
+    uint64_t chars_size{0};
+    for (const auto* str : m_strings) {
+        if (chars_size + str->size() > UINT32_MAX) {
+            throw BundleError("string table exceeds 4 GiB");
+        }
+        put(StringSpan{static_cast<uint32_t>(chars_size),
+                       static_cast<uint32_t>(str->size())});
+        chars_size += str->size();
+    }
+    for (const auto* str : m_strings) {
+        m_bytes.append(*str);
+    }
+
+    align();
+    header.versions_offset = m_bytes.size();
+    header.version_count = static_cast<uint32_t>(m_versions.size());
+    for (const auto& [version, ids_indices] : m_versions) {
+        put(version);
+        put(static_cast<uint32_t>(ids_indices.size()));
+        for (const auto index : ids_indices) {
+            put(index);
+        }
+    }
+
+    align();
+    header.ids_offset = m_bytes.size();
+    header.ids_count = static_cast<uint32_t>(m_ids.size());
+    for (const auto& ids : m_ids) {
+        put(ids);
+    }
+
+    header.file_size = m_bytes.size();
+    std::memcpy(m_bytes.data(), &header, sizeof(BundleHeader));
+    return std::move(m_bytes);
+}
+
+} // namespace
+
+void EntryRecord::clear() {
+    type = EntryType::VALUE;
+    key = {};
+    value = nullptr;
+    name = {};
+    args.clear();
+    offset.reset();
+    scale.reset();
+    promote_double = false;
+    slice_indices.clear();
+    parameters.clear();
+    output_type = {};
+}
+
+/**
+ * @brief EntryType of a JSON MAP_TYPE string
+ *
+ * @param map_type MAP_TYPE, eg. PLUGIN
+ * @param type [out] entry type
+ * @return true if recognised
+ */
+bool parse_entry_type(std::string_view map_type, EntryType& type) {
+    for (const auto& [name, entry_type] : map_type_names) {
+        if (name == map_type) {
+            type = entry_type;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Resolve an optional OFFSET/SCALE field of a PLUGIN entry
+ *
+ * Floats are used as is, strings are rendered against the IDS globals and
+ * converted. Unconvertible strings and any other type are treated as
+ * absent.
+ *
+ * @param value JSON mapping entry
+ * @param field field name, OFFSET or SCALE
+ * @param globals IDS globals
+ * @return std::optional<float> resolved value
+ */
+std::optional<float> resolve_float_field(const nlohmann::json& value,
+                                         const std::string& field,
+                                         const nlohmann::json& globals) {
+
+    std::optional<float> opt_float{std::nullopt};
+    const auto found = value.find(field);
+    if (found == value.end() || found->is_null()) {
+        return opt_float;
+    }
+    if (found->is_number_float()) {
+        opt_float = found->get<float>();
+    } else if (found->is_string()) {
+        try {
+            opt_float = std::stof(
+                inja::render(found->get_ref<const std::string&>(), globals));
+        } catch (const std::invalid_argument& e) {
+            // Not a number once rendered
+        }
+    }
+    return opt_float;
+}
+
+/**
+ * @brief Extract the fields of one JSON mapping entry
+ *
+ * @param key mapping path
+ * @param value JSON mapping entry, must outlive the record
+ * @param globals IDS globals, used to resolve OFFSET and SCALE
+ * @param record [out] entry fields
+ * @return int error_code, 1 for an unrecognised MAP_TYPE
+ * @throw nlohmann::json::exception for missing or mistyped fields
+ */
+int entry_from_json(std::string_view key, const nlohmann::json& value,
+                    const nlohmann::json& globals, EntryRecord& record) {
+
+    record.clear();
+    record.key = key;
+    if (!parse_entry_type(
+            value.at("MAP_TYPE").get_ref<const std::string&>(),
+            record.type)) {
+        return 1;
+    }
+
+    switch (record.type) {
+    case EntryType::VALUE:
+        record.value = value.at("VALUE");
+        break;
+    case EntryType::PLUGIN:
+        record.name = value.at("PLUGIN").get_ref<const std::string&>();
+        for (const auto& [name, arg] :
+             value.at("ARGS").get_ref<const nlohmann::json::object_t&>()) {
+            record.args.emplace_back(name, arg);
+        }
+        record.offset = resolve_float_field(value, "OFFSET", globals);
+        record.scale = resolve_float_field(value, "SCALE", globals);
+        record.promote_double = value.value("PROMOTE_DOUBLE", false);
+        break;
+    case EntryType::DIM:
+        record.name = value.at("DIM_PROBE").get_ref<const std::string&>();
+        break;
+    case EntryType::SLICE: {
+        const auto& slice_indices =
+            value.at("SLICE_INDEX").get_ref<const nlohmann::json::array_t&>();
+        for (const auto& index : slice_indices) {
+            record.slice_indices.emplace_back(
+                index.get_ref<const std::string&>());
+        }
+        record.name = value.at("SIGNAL").get_ref<const std::string&>();
+        break;
+    }
+    case EntryType::EXPR: {
+        record.name = value.at("EXPR").get_ref<const std::string&>();
+        for (const auto& [name, signal] :
+             value.at("PARAMETERS")
+                 .get_ref<const nlohmann::json::object_t&>()) {
+            record.parameters.emplace_back(
+                name, signal.get_ref<const std::string&>());
+        }
+        const auto output_type = value.find("OUTPUT_TYPE");
+        record.output_type =
+            output_type != value.end() && output_type->is_string()
+                ? std::string_view{output_type->get_ref<const std::string&>()}
+                : std::string_view{"float"};
+        break;
+    }
+    case EntryType::CUSTOM:
+        record.name = value.at("CUSTOM_TYPE").get_ref<const std::string&>();
+        break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Compile a mapping directory into a bundle file
+ *
+ * Every IDS listed for any IMAS version in mappings.cfg.json is included.
+ * The bundle is written beside the destination and renamed into place, so
+ * servers mapping a previous bundle keep a consistent view.
+ *
+ * @param mapping_dir mapping directory, as JSON_MAPPING_DIR
+ * @param bundle_path destination file
+ * @param error [out] reason for failure
+ * @return int error_code
+ */
+int compile_bundle(const std::string& mapping_dir,
+                   const std::string& bundle_path, std::string& error) {
+
+    try {
+        const auto config = read_json_file(mapping_dir + "/mappings.cfg.json");
+        BundleWriter writer;
+        for (const auto& [version, ids_list] : config.items()) {
+            const auto ids_names = ids_list.get<std::vector<std::string>>();
+            for (const auto& ids_name : ids_names) {
+                if (writer.has_ids(ids_name)) {
+                    continue;
+                }
+                const std::string ids_dir{mapping_dir + "/mappings/" +
+                                          ids_name + "/"};
+                writer.add_ids(ids_name,
+                               read_json_file(ids_dir + "globals.json"),
+                               read_json_file(ids_dir + "mappings.json"));
+            }
+            writer.add_version(version, ids_names);
+        }
+        const auto bytes = writer.finish();
+
+        const std::string temp_path{bundle_path + ".tmp"};
+        std::ofstream bundle_file(temp_path,
+                                  std::ios::binary | std::ios::trunc);
+        bundle_file.write(bytes.data(),
+                          static_cast<std::streamsize>(bytes.size()));
+        bundle_file.close();
+        if (!bundle_file) {
+            throw BundleError("cannot write " + temp_path);
+        }
+        if (std::rename(temp_path.c_str(), bundle_path.c_str()) != 0) {
+            throw BundleError("cannot rename " + temp_path + " to " +
+                              bundle_path);
+        }
+    } catch (const std::exception& ex) {
+        error = ex.what();
+        return 1;
+    }
+    return 0;
+}
+
+MappingBundle::~MappingBundle() { close(); }
+
+/**
+ * @brief Map a bundle file and validate its tables
+ *
+ * @param bundle_path bundle written by compile_bundle
+ * @param error [out] reason for failure
+ * @return int error_code
+ */
+int MappingBundle::open(const std::string& bundle_path, std::string& error) {
+
+    close();
+    const int fd = ::open(bundle_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "cannot open " + bundle_path;
+        return 1;
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 ||
+        static_cast<size_t>(file_stat.st_size) < sizeof(BundleHeader)) {
+        ::close(fd);
+        error = bundle_path + " is not a mapping bundle";
+        return 1;
+    }
+    const auto size = static_cast<size_t>(file_stat.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "cannot map " + bundle_path;
+        return 1;
+    }
+    m_data = static_cast<const char*>(mapped);
+    m_size = size;
+
+    try {
+        read_tables();
+    } catch (const std::exception& ex) {
+        close();
+        error = bundle_path + ": " + ex.what();
+        return 1;
+    }
+    return 0;
+}
+
+void MappingBundle::read_tables() {
+
+    BundleHeader header;
+    std::memcpy(&header, m_data, sizeof(BundleHeader));
+    if (!std::equal(std::begin(bundle_magic), std::end(bundle_magic),
+                    header.magic)) {
+        throw BundleError("not a mapping bundle");
+    }
+    if (header.byte_order != bundle_byte_order) {
+        throw BundleError("bundle byte order does not match this host");
+    }
+    if (header.format_version != bundle_format_version) {
+        throw BundleError("unsupported bundle format version " +
+                          std::to_string(header.format_version));
+    }
+    if (header.file_size != m_size ||
+        header.strings_offset > header.versions_offset ||
+        header.versions_offset > header.ids_offset) {
+        throw BundleError("bundle truncated or corrupt");
+    }
+
+    auto strings =
+        section(m_data, m_size, header.strings_offset,
+                header.versions_offset - header.strings_offset);
+    m_string_count = header.string_count;
+    m_string_spans =
+        strings.take(uint64_t{m_string_count} * sizeof(StringSpan));
+    m_string_chars = m_string_spans + m_string_count * sizeof(StringSpan);
+    m_string_chars_size = static_cast<size_t>(
+        m_data + header.versions_offset - m_string_chars);
+
+    auto ids_table = section(m_data, m_size, header.ids_offset,
+                             m_size - header.ids_offset);
+    m_ids.reserve(header.ids_count);
+    for (uint32_t i = 0; i < header.ids_count; ++i) {
+        const auto ids = ids_table.read<IDSRecord>();
+        // Payload sections lie between the header and the string table
+        section(m_data, header.strings_offset, ids.globals_offset,
+                ids.globals_size);
+        section(m_data, header.strings_offset, ids.entries_offset,
+                ids.entries_size);
+        m_ids_index.emplace(string(ids.name), i);
+        m_ids.push_back(ids);
+    }
+
+    auto versions = section(m_data, m_size, header.versions_offset,
+                            header.ids_offset - header.versions_offset);
+    m_versions.reserve(header.version_count);
+    for (uint32_t i = 0; i < header.version_count; ++i) {
+        const auto version = string(versions.read<uint32_t>());
+        std::vector<uint32_t> ids_indices(versions.read<uint32_t>());
+        for (auto& index : ids_indices) {
+            index = versions.read<uint32_t>();
+            if (index >= m_ids.size()) {
+                throw BundleError("IDS index out of range");
+            }
+        }
+        m_versions.emplace_back(version, std::move(ids_indices));
+    }
+}
+
+void MappingBundle::close() {
+    if (m_data != nullptr) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_string_spans = nullptr;
+    m_string_chars = nullptr;
+    m_string_chars_size = 0;
+    m_string_count = 0;
+    m_versions.clear();
+    m_ids.clear();
+    m_ids_index.clear();
+}
+
+std::string_view MappingBundle::string(uint32_t id) const {
+    if (id >= m_string_count) {
+        throw BundleError("string id out of range");
+    }
+    StringSpan span;
+    std::memcpy(&span, m_string_spans + id * sizeof(StringSpan),
+                sizeof(StringSpan));
+    if (uint64_t{span.offset} + span.length > m_string_chars_size) {
+        throw BundleError("string out of range");
+    }
+    return {m_string_chars + span.offset, span.length};
+}
+
+bool MappingBundle::contains(std::string_view imas_version,
+                             std::string_view ids) const {
+    const auto names = ids_names(imas_version);
+    return std::find(names.begin(), names.end(), ids) != names.end();
+}
+
+/**
+ * @brief IDSs listed for an IMAS version
+ */
+std::vector<std::string_view>
+MappingBundle::ids_names(std::string_view imas_version) const {
+    std::vector<std::string_view> names;
+    for (const auto& [version, ids_indices] : m_versions) {
+        if (version != imas_version) {
+            continue;
+        }
+        for (const auto index : ids_indices) {
+            names.push_back(string(m_ids[index].name));
+        }
+    }
+    return names;
+}
+
+const IDSRecord* MappingBundle::find_ids(std::string_view ids) const {
+    const auto found = m_ids_index.find(ids);
+    return found != m_ids_index.end() ? &m_ids[found->second] : nullptr;
+}
+
+/**
+ * @brief Decode the globals of an IDS
+ *
+ * @throw nlohmann::json::exception if the globals are corrupt
+ */
+nlohmann::json MappingBundle::read_globals(const IDSRecord& ids) const {
+    auto globals =
+        section(m_data, m_size, ids.globals_offset, ids.globals_size);
+    const char* packed = globals.take(ids.globals_size);
+    return nlohmann::json::from_msgpack(packed, packed + ids.globals_size);
+}
+
+template <typename T>
+static nlohmann::json read_array(BundleCursor& cursor) {
+    const auto count = cursor.read<uint32_t>();
+    const char* data = cursor.take(uint64_t{count} * sizeof(T));
+    nlohmann::json values = nlohmann::json::array();
+    auto& array = values.get_ref<nlohmann::json::array_t&>();
+    array.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        T value;
+        std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+        array.emplace_back(value);
+    }
+    return values;
+}
+
+nlohmann::json MappingBundle::read_value(BundleCursor& cursor) const {
+
+    switch (static_cast<ValueKind>(cursor.read<uint8_t>())) {
+    case ValueKind::NONE:
+        return nullptr;
+    case ValueKind::BOOL_FALSE:
+        return false;
+    case ValueKind::BOOL_TRUE:
+        return true;
+    case ValueKind::INTEGER:
+        return cursor.read<int64_t>();
+    case ValueKind::UNSIGNED:
+        return cursor.read<uint64_t>();
+    case ValueKind::FLOAT:
+        return cursor.read<double>();
+    case ValueKind::STRING:
+        return std::string{string(cursor.read<uint32_t>())};
+    case ValueKind::INTEGER_ARRAY:
+        return read_array<int64_t>(cursor);
+    case ValueKind::UNSIGNED_ARRAY:
+        return read_array<uint64_t>(cursor);
+    case ValueKind::FLOAT_ARRAY:
+        return read_array<double>(cursor);
+    case ValueKind::MSGPACK: {
+        const auto size = cursor.read<uint32_t>();
+        const char* packed = cursor.take(size);
+        return nlohmann::json::from_msgpack(packed, packed + size);
+    }
+    default:
+        throw BundleError("unknown value kind");
+    }
+}
+
+void MappingBundle::read_entry(BundleCursor& cursor,
+                               EntryRecord& record) const {
+
+    record.clear();
+    record.key = string(cursor.read<uint32_t>());
+    const auto type = cursor.read<uint8_t>();
+    if (type >= entry_type_count) {
+        throw BundleError("unknown entry type");
+    }
+    record.type = static_cast<EntryType>(type);
+
+    switch (record.type) {
+    case EntryType::VALUE:
+        record.value = read_value(cursor);
+        break;
+    case EntryType::PLUGIN: {
+        record.name = string(cursor.read<uint32_t>());
+        const auto n_args = cursor.read<uint32_t>();
+        for (uint32_t i = 0; i < n_args; ++i) {
+            const auto name = string(cursor.read<uint32_t>());
+            record.args.emplace_back(name, read_value(cursor));
+        }
+        const auto flags = cursor.read<uint8_t>();
+        const auto offset = cursor.read<float>();
+        const auto scale = cursor.read<float>();
+        if (flags & has_offset_flag) {
+            record.offset = offset;
+        }
+        if (flags & has_scale_flag) {
+            record.scale = scale;
+        }
+        record.promote_double = (flags & promote_double_flag) != 0;
+        break;
+    }
+    case EntryType::DIM:
+    case EntryType::CUSTOM:
+        record.name = string(cursor.read<uint32_t>());
+        break;
+    case EntryType::SLICE: {
+        const auto n_indices = cursor.read<uint32_t>();
+        for (uint32_t i = 0; i < n_indices; ++i) {
+            record.slice_indices.push_back(string(cursor.read<uint32_t>()));
+        }
+        record.name = string(cursor.read<uint32_t>());
+        break;
+    }
+    case EntryType::EXPR: {
+        record.name = string(cursor.read<uint32_t>());
+        const auto n_parameters = cursor.read<uint32_t>();
+        for (uint32_t i = 0; i < n_parameters; ++i) {
+            const auto name = string(cursor.read<uint32_t>());
+            record.parameters.emplace_back(name,
+                                           string(cursor.read<uint32_t>()));
+        }
+        record.output_type = string(cursor.read<uint32_t>());
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Decode the entries of an IDS, one record at a time
+ *
+ * @param ids IDS from find_ids
+ * @param callback called per entry, the record is reused between calls
+ * @throw BundleError if the entries are corrupt
+ */
+void MappingBundle::read_entries(
+    const IDSRecord& ids,
+    const std::function<void(const EntryRecord&)>& callback) const {
+
+    auto entries =
+        section(m_data, m_size, ids.entries_offset, ids.entries_size);
+    EntryRecord record;
+    for (uint32_t i = 0; i < ids.entry_count; ++i) {
+        read_entry(entries, record);
+        callback(record);
+    }
+    if (!entries.at_end()) {
+        throw BundleError("trailing bytes after IDS entries");
+    }
+}
+
+} // namespace JMP::bundle
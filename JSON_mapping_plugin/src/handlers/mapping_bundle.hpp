@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace JMP::bundle {
+
+/**
+ * Binary mapping bundle, a mapping directory (mappings.cfg.json plus the
+ * globals.json and mappings.json of every IDS) compiled offline into one
+ * file which is memory-mapped and decoded without any JSON text parsing.
+ *
+ * Layout (host byte order, checked on open):
+ *   BundleHeader
+ *   per IDS: globals (MessagePack) and the entry record stream
+ *   string table: StringSpan[string_count] then the characters
+ *   version table: per version {name, ids_count, ids_index[ids_count]}
+ *   IDS table: IDSRecord[ids_count]
+ *
+ * All strings (paths, plugin arguments, templates) are interned once in the
+ * string table and referenced by index.
+ */
+inline constexpr char bundle_magic[8]{'J', 'M', 'P', 'B', 'U', 'N', 'D', 'L'};
+inline constexpr uint32_t bundle_format_version{1};
+inline constexpr uint32_t bundle_byte_order{0x01020304};
+
+enum class EntryType : uint8_t { VALUE, PLUGIN, DIM, SLICE, EXPR, CUSTOM };
+inline constexpr size_t entry_type_count{6};
+
+struct BundleHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t strings_offset;
+    uint64_t versions_offset;
+    uint64_t ids_offset;
+    uint32_t string_count;
+    uint32_t version_count;
+    uint32_t ids_count;
+    uint32_t reserved;
+};
+static_assert(sizeof(BundleHeader) == 64);
+
+struct StringSpan {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct IDSRecord {
+    uint32_t name;
+    uint32_t entry_count;
+    // Entries per EntryType, so each arena is reserved once
+    uint32_t type_counts[entry_type_count];
+    uint64_t globals_offset;
+    uint64_t globals_size;
+    uint64_t entries_offset;
+    uint64_t entries_size;
+};
+static_assert(sizeof(IDSRecord) == 64);
+
+/**
+ * @class BundleError
+ * @brief Malformed or truncated bundle contents
+ */
+class BundleError : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Fields of one mapping entry, independent of where it was read from
+ *
+ * Filled from a JSON mapping entry or decoded from a bundle, string views
+ * point into the JSON document or the mapped bundle respectively. Only the
+ * fields of the entry type are meaningful.
+ */
+struct EntryRecord {
+    EntryType type{EntryType::VALUE};
+    std::string_view key;
+    // VALUE
+    nlohmann::json value;
+    // PLUGIN name, DIM_PROBE, SLICE SIGNAL, EXPR or CUSTOM_TYPE
+    std::string_view name;
+    // PLUGIN ARGS
+    std::vector<std::pair<std::string_view, nlohmann::json>> args;
+    std::optional<float> offset;
+    std::optional<float> scale;
+    bool promote_double{false};
+    // SLICE_INDEX
+    std::vector<std::string_view> slice_indices;
+    // EXPR PARAMETERS and OUTPUT_TYPE
+    std::vector<std::pair<std::string_view, std::string_view>> parameters;
+    std::string_view output_type;
+
+    void clear();
+};
+
+bool parse_entry_type(std::string_view map_type, EntryType& type);
+
+std::optional<float> resolve_float_field(const nlohmann::json& value,
+                                         const std::string& field,
+                                         const nlohmann::json& globals);
+
+int entry_from_json(std::string_view key, const nlohmann::json& value,
+                    const nlohmann::json& globals, EntryRecord& record);
+
+int compile_bundle(const std::string& mapping_dir,
+                   const std::string& bundle_path, std::string& error);
+
+class BundleCursor;
+
+/**
+ * @class MappingBundle
+ * @brief Read-only view of a memory-mapped mapping bundle
+ *
+ * The header, string, version and IDS tables are validated on open. The
+ * globals and entries of an IDS are only decoded when requested, so a
+ * worker touching a single IDS pays for that IDS alone.
+ */
+class MappingBundle {
+  public:
+    MappingBundle() = default;
+    ~MappingBundle();
+    MappingBundle(const MappingBundle&) = delete;
+    MappingBundle& operator=(const MappingBundle&) = delete;
+
+    int open(const std::string& bundle_path, std::string& error);
+    void close();
+    [[nodiscard]] bool is_open() const { return m_data != nullptr; }
+
+    [[nodiscard]] bool contains(std::string_view imas_version,
+                                std::string_view ids) const;
+    [[nodiscard]] std::vector<std::string_view>
+    ids_names(std::string_view imas_version) const;
+    [[nodiscard]] const IDSRecord* find_ids(std::string_view ids) const;
+
+    [[nodiscard]] nlohmann::json read_globals(const IDSRecord& ids) const;
+    void read_entries(
+        const IDSRecord& ids,
+        const std::function<void(const EntryRecord&)>& callback) const;
+
+  private:
+    void read_tables();
+    [[nodiscard]] std::string_view string(uint32_t id) const;
+    nlohmann::json read_value(BundleCursor& cursor) const;
+    void read_entry(BundleCursor& cursor, EntryRecord& record) const;
+
+    const char* m_data{nullptr};
+    size_t m_size{0};
+    const char* m_string_spans{nullptr};
+    const char* m_string_chars{nullptr};
+    size_t m_string_chars_size{0};
+    uint32_t m_string_count{0};
+    // IMAS version -> indices into m_ids
+    std::vector<std::pair<std::string_view, std::vector<uint32_t>>>
+        m_versions;
+    std::vector<IDSRecord> m_ids;
+    std::unordered_map<std::string_view, uint32_t> m_ids_index;
+};
+
+} // namespace JMP::bundle
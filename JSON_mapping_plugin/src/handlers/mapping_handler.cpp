@@ -1,184 +1,640 @@
 #include "mapping_handler.hpp"
 
-#include <inja/inja.hpp>
+#include <algorithm>
+#include <array>
+#include <filesystem>
 #include <logging/logging.h>
 #include <unordered_map>
 
-#include "map_types/custom_entry.hpp"
-#include "map_types/dim_entry.hpp"
-#include "map_types/expr_entry.hpp"
-#include "map_types/map_entry.hpp"
-#include "map_types/slice_entry.hpp"
+#include "utils/logger.hpp"
 
-MappingPair MappingHandler::read_mappings(const std::string& request_ids) {
-    // AJP :: Safety check if ids request not in mapping json (and typo
-    // obviously)
-    return std::make_pair(std::ref(m_ids_attributes[request_ids]),
-                          std::ref(m_ids_map_register[request_ids]));
+namespace {
+
+/**
+ * @brief Construct the mapping entry described by a record in its arena
+ *
+ * @param map_reg IDS register, arenas reserved for the entry type
+ * @param record entry fields, from JSON or a bundle
+ */
+void emplace_entry(IDSMapRegister_t& map_reg,
+                   const JMP::bundle::EntryRecord& record) {
+
+    using JMP::bundle::EntryType;
+    switch (record.type) {
+    case EntryType::VALUE: {
+        map_reg.emplace<ValueEntry>(record.key, record.value);
+        break;
+    }
+    case EntryType::PLUGIN: {
+        const std::string plugin{record.name};
+        MapArgs_t args;
+        for (const auto& [name, arg] : record.args) {
+            args.emplace(name, arg);
+        }
+        map_reg.emplace<MapEntry>(
+            record.key,
+            std::make_pair(nlohmann::json(plugin).get<PluginType>(), plugin),
+            std::move(args), record.offset, record.scale,
+            record.promote_double);
+        break;
+    }
+    case EntryType::DIM: {
+        map_reg.emplace<DimEntry>(record.key, std::string{record.name});
+        break;
+    }
+    case EntryType::SLICE: {
+        map_reg.emplace<SliceEntry>(
+            record.key,
+            std::vector<std::string>(record.slice_indices.begin(),
+                                     record.slice_indices.end()),
+            std::string{record.name});
+        break;
+    }
+    case EntryType::EXPR: {
+        std::unordered_map<std::string, std::string> parameters;
+        for (const auto& [name, signal] : record.parameters) {
+            parameters.emplace(name, signal);
+        }
+        map_reg.emplace<ExprEntry>(
+            record.key, std::string{record.name}, std::move(parameters),
+            nlohmann::json(std::string{record.output_type})
+                .get<ExprOutputType>());
+        break;
+    }
+    case EntryType::CUSTOM: {
+        map_reg.emplace<CustomEntry>(
+            record.key,
+            nlohmann::json(std::string{record.name}).get<CustomMapType_t>());
+        break;
+    }
+    }
+}
+
+template <typename Counts>
+void reserve_entries(IDSMapRegister_t& map_reg, const Counts& type_counts) {
+    using JMP::bundle::EntryType;
+    const auto count = [&](EntryType type) {
+        return static_cast<size_t>(type_counts[static_cast<size_t>(type)]);
+    };
+    map_reg.reserve<ValueEntry>(count(EntryType::VALUE));
+    map_reg.reserve<MapEntry>(count(EntryType::PLUGIN));
+    map_reg.reserve<DimEntry>(count(EntryType::DIM));
+    map_reg.reserve<SliceEntry>(count(EntryType::SLICE));
+    map_reg.reserve<ExprEntry>(count(EntryType::EXPR));
+    map_reg.reserve<CustomEntry>(count(EntryType::CUSTOM));
+}
+
+/**
+ * @brief Read and parse one JSON file
+ *
+ * @param file_path JSON file
+ * @param data parsed document
+ * @param error description on failure
+ * @return int error_code
+ */
+int load_json_file(const std::string& file_path, nlohmann::json& data,
+                   std::string& error) {
+
+    std::ifstream json_file(file_path);
+    if (!json_file) {
+        error = "MappingHandler::load_json_file - Cannot open " + file_path;
+        return 1;
+    }
+    try {
+        json_file >> data;
+    } catch (nlohmann::json::exception& ex) {
+        error = "MappingHandler::load_json_file - " + file_path + ": ";
+        error.append(ex.what());
+        return 1;
+    }
+    return 0;
+}
+
+// Lexically normal path without a trailing separator, for comparing watched
+// and configured paths
+std::filesystem::path normal_path(const std::filesystem::path& path) {
+    auto normal = path.lexically_normal();
+    if (!normal.has_filename() && normal.has_parent_path()) {
+        normal = normal.parent_path();
+    }
+    return normal;
+}
+
+} // namespace
+
+/**
+ * @brief Read the mapping config (or open the bundle), load every IDS in
+ * EAGER mode and start watching the mapping files if enabled
+ *
+ * @return int error_code
+ */
+int MappingHandler::init() {
+
+    if (m_init) {
+        return 0;
+    }
+    std::string error;
+    if (load_config(error) != 0) {
+        RAISE_PLUGIN_ERROR(error.c_str());
+    }
+    if (m_load_mode == LoadMode::EAGER) {
+        load_all();
+    }
+    if (m_watch) {
+        start_watch();
+    }
+
+    m_init = true;
+    return 0;
+}
+
+/**
+ * @brief Stop watching and drop every loaded IDS, the next init reads the
+ * mapping files again
+ *
+ * Requests still holding IDSMappings keep them alive until they finish.
+ *
+ * @return int error_code
+ */
+int MappingHandler::reset() {
+
+    m_watcher.stop();
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    std::atomic_store(&m_registry, std::shared_ptr<const IDSMappingsStore_t>{});
+    ++m_generation;
+    m_loaded_ids.clear();
+    m_mapping_config.clear();
+    m_bundle.close();
+    m_init = false;
+    return 0;
+}
+
+/**
+ * @brief Mappings of an IDS, loaded first in LAZY mode
+ *
+ * @param request_ids IDS name
+ * @return IDSMappingsPtr snapshot of the IDS mappings, unchanged by later
+ * reloads, empty if the IDS has no mappings
+ */
+IDSMappingsPtr MappingHandler::read_mappings(std::string_view request_ids) {
+
+    const auto find = [&]() -> IDSMappingsPtr {
+        const auto registry = std::atomic_load(&m_registry);
+        if (registry == nullptr) {
+            return nullptr;
+        }
+        const auto map_it = registry->find(request_ids);
+        return map_it != registry->end() ? map_it->second : nullptr;
+    };
+
+    auto mappings = find();
+    if (mappings == nullptr && m_load_mode == LoadMode::LAZY &&
+        load_ids(request_ids) == 0) {
+        mappings = find();
+    }
+    // No mappings for this IDS, nothing inserted
+    return mappings != nullptr ? mappings : m_empty_mappings;
+}
+
+/**
+ * @brief Mappings of an IDS and the registry generation they belong to
+ *
+ * The generation is read so that any later load or reload changes it, a
+ * result computed from these mappings is current while generation() still
+ * equals it.
+ *
+ * @param request_ids IDS name
+ * @param generation [out] registry generation of the returned snapshot
+ * @return IDSMappingsPtr as read_mappings(request_ids)
+ */
+IDSMappingsPtr MappingHandler::read_mappings(std::string_view request_ids,
+                                             uint64_t& generation) {
+
+    generation = m_generation;
+    auto mappings = read_mappings(request_ids);
+    // Published meanwhile (eg. a LAZY load by this call), read again
+    while (m_generation != generation) {
+        generation = m_generation;
+        mappings = read_mappings(request_ids);
+    }
+    return mappings;
 }
 
 int MappingHandler::set_map_dir(const std::string& mapping_dir) {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
     m_mapping_dir = mapping_dir;
     return 0;
 }
 
+/**
+ * @brief Load mappings from a bundle written by compile_bundle instead of
+ * the mapping directory
+ *
+ * @param bundle_path bundle file, empty to use the mapping directory
+ * @return int error_code
+ */
+int MappingHandler::set_bundle_path(const std::string& bundle_path) {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    m_bundle_path = bundle_path;
+    return 0;
+}
+
+int MappingHandler::set_load_mode(LoadMode load_mode) {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    m_load_mode = load_mode;
+    return 0;
+}
+
+/**
+ * @brief Reload changed mapping files in the background, takes effect on
+ * the next init
+ *
+ * @param watch watch the mapping directory (or bundle) with inotify
+ * @return int error_code
+ */
+int MappingHandler::set_watch(bool watch) {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    m_watch = watch;
+    return 0;
+}
+
+void MappingHandler::set_reload_listener(ReloadListener_t listener) {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    m_reload_listener = std::move(listener);
+}
+
+int MappingHandler::load_config(std::string& error) {
+
+    if (!m_bundle_path.empty()) {
+        if (m_bundle.open(m_bundle_path, error) != 0) {
+            error.insert(0, "MappingHandler::load_config - ");
+            return 1;
+        }
+        return 0;
+    }
+
+    nlohmann::json mapping_config;
+    if (load_json_file(m_mapping_dir + "/mappings.cfg.json", mapping_config,
+                       error) != 0) {
+        return 1;
+    }
+    m_mapping_config = std::move(mapping_config);
+    return 0;
+}
+
+/**
+ * @brief IDSs with mappings for the current IMAS version
+ */
+std::vector<std::string> MappingHandler::listed_ids() const {
+
+    std::vector<std::string> ids_names;
+    if (m_bundle.is_open()) {
+        for (const auto ids_name : m_bundle.ids_names(m_imas_version)) {
+            ids_names.emplace_back(ids_name);
+        }
+        return ids_names;
+    }
+    const auto version = m_mapping_config.find(m_imas_version);
+    if (version == m_mapping_config.end() || !version->is_array()) {
+        return ids_names;
+    }
+    for (const auto& ids_name : *version) {
+        if (ids_name.is_string()) {
+            ids_names.push_back(ids_name.get<std::string>());
+        }
+    }
+    return ids_names;
+}
+
+bool MappingHandler::ids_listed(std::string_view ids_str) const {
+
+    if (m_bundle.is_open()) {
+        return m_bundle.contains(m_imas_version, ids_str);
+    }
+    const auto version = m_mapping_config.find(m_imas_version);
+    if (version == m_mapping_config.end() || !version->is_array()) {
+        return false;
+    }
+    return std::any_of(version->begin(), version->end(),
+                       [&](const nlohmann::json& ids_name) {
+                           return ids_name.is_string() &&
+                                  ids_name.get_ref<const std::string&>() ==
+                                      ids_str;
+                       });
+}
+
 int MappingHandler::load_all() {
 
-    std::ifstream map_cfg_file(m_mapping_dir + "/mappings.cfg.json");
-    if (map_cfg_file) {
-        map_cfg_file >> m_mapping_config;
-        map_cfg_file.close();
-    } else {
-        RAISE_PLUGIN_ERROR("MappingHandler::load_configs - Cannot open JSON "
-                           "mapping config file");
+    for (const auto& ids_str : listed_ids()) {
+        load_ids(ids_str);
     }
+    return 0;
+}
+
+/**
+ * @brief Load the globals and mappings of a single IDS, once
+ *
+ * @param ids_view IDS name, must be listed in mappings.cfg.json (or the
+ * bundle) for the current IMAS version
+ * @return int error_code, 0 if loaded now or previously, 1 if the IDS is
+ * not listed or failed to build (retried on the next call)
+ */
+int MappingHandler::load_ids(std::string_view ids_view) {
 
-    for (const auto& ids_str :
-         m_mapping_config[m_imas_version].get<std::vector<std::string>>()) {
-        load_globals(ids_str);
-        load_mappings(ids_str);
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    if (m_loaded_ids.find(ids_view) != m_loaded_ids.end()) {
+        return 0;
+    }
+    if (!ids_listed(ids_view)) {
+        UDA_LOG(UDA_LOG_DEBUG,
+                "\nMappingHandler::load_ids - IDS not in mapping config\n");
+        return 1;
     }
 
+    // Marked loaded only once built, a failed load is retried by the next
+    // request
+    const std::string ids_str{ids_view};
+    auto mappings = std::make_shared<IDSMappings>();
+    std::string error;
+    if (build_ids(ids_str, *mappings, error) != 0) {
+        RAISE_PLUGIN_ERROR(error.c_str());
+    }
+    publish(ids_str, std::move(mappings));
+    m_loaded_ids.insert(ids_str);
     return 0;
 }
 
-int MappingHandler::load_globals(const std::string& ids_str) {
+/**
+ * @brief Read the globals and mappings of a single IDS, from the mapping
+ * directory or the bundle
+ *
+ * @param ids_str IDS name
+ * @param mappings filled on success
+ * @param error description on failure
+ * @return int error_code
+ */
+int MappingHandler::build_ids(const std::string& ids_str,
+                              IDSMappings& mappings,
+                              std::string& error) const {
 
-    std::string file_path{m_mapping_dir + "/mappings/" + ids_str + "/" +
-                          "globals.json"};
+    if (m_bundle.is_open()) {
+        return load_bundle_ids(ids_str, mappings, error);
+    }
 
-    std::ifstream globals_file;
-    globals_file.open(file_path);
-    if (globals_file) {
-        nlohmann::json temp_globals;
-        try {
-            globals_file >> temp_globals;
-        } catch (nlohmann::json::exception& ex) {
-            globals_file.close();
-            std::string json_error{"MappingHandler::load_globals - "};
-            json_error.append(ex.what());
-            RAISE_PLUGIN_ERROR(json_error.c_str());
-        }
-        globals_file.close();
+    const std::string ids_dir{m_mapping_dir + "/mappings/" + ids_str + "/"};
+    nlohmann::json data;
+    if (load_json_file(ids_dir + "globals.json", mappings.globals, error) !=
+            0 ||
+        load_json_file(ids_dir + "mappings.json", data, error) != 0) {
+        return 1;
+    }
+    try {
+        init_mappings(data, mappings.globals, mappings.entries);
+    } catch (const std::exception& ex) {
+        error = "MappingHandler::init_mappings - " + ids_str + ": ";
+        error.append(ex.what());
+        return 1;
+    }
+    return 0;
+}
 
-        m_ids_attributes[ids_str] = temp_globals; // Record globals
+/**
+ * @brief Load the globals and mappings of a single IDS from the bundle, no
+ * JSON text is parsed
+ *
+ * @param ids_str IDS name
+ * @param mappings filled on success
+ * @param error description on failure
+ * @return int error_code
+ */
+int MappingHandler::load_bundle_ids(const std::string& ids_str,
+                                    IDSMappings& mappings,
+                                    std::string& error) const {
 
-    } else {
-        RAISE_PLUGIN_ERROR(
-            "MappingHandler::load_globals- Cannot open JSON globals file");
+    const auto* ids = m_bundle.find_ids(ids_str);
+    if (ids == nullptr) {
+        error = "MappingHandler::load_bundle_ids - IDS missing from bundle";
+        return 1;
+    }
+    try {
+        mappings.globals = m_bundle.read_globals(*ids);
+        reserve_entries(mappings.entries, ids->type_counts);
+        m_bundle.read_entries(*ids,
+                              [&](const JMP::bundle::EntryRecord& record) {
+                                  emplace_entry(mappings.entries, record);
+                              });
+    } catch (const std::exception& ex) {
+        error = "MappingHandler::load_bundle_ids - ";
+        error.append(ex.what());
+        return 1;
     }
     return 0;
 }
 
-int MappingHandler::load_mappings(const std::string& ids_str) {
+void MappingHandler::init_mappings(const nlohmann::json& data,
+                                   const nlohmann::json& globals,
+                                   IDSMapRegister_t& map_reg) {
 
-    std::string file_path{m_mapping_dir + "/mappings/" + ids_str + "/" +
-                          "mappings.json"};
+    // First pass, count entries per type so each arena is allocated once
+    std::array<size_t, JMP::bundle::entry_type_count> type_counts{};
+    for (const auto& [key, value] : data.items()) {
+        JMP::bundle::EntryType type;
+        if (JMP::bundle::parse_entry_type(
+                value.at("MAP_TYPE").get_ref<const std::string&>(), type)) {
+            ++type_counts[static_cast<size_t>(type)];
+        }
+    }
+    reserve_entries(map_reg, type_counts);
 
-    std::ifstream map_file;
-    map_file.open(file_path);
-    if (map_file) {
-        nlohmann::json temp_mappings;
-        try {
-            map_file >> temp_mappings;
-        } catch (nlohmann::json::exception& ex) {
-            map_file.close();
-            std::string json_error{"MappingHandler::load_mappings - "};
-            json_error.append(ex.what());
-            RAISE_PLUGIN_ERROR(json_error.c_str());
+    JMP::bundle::EntryRecord record;
+    for (const auto& [key, value] : data.items()) {
+        if (JMP::bundle::entry_from_json(key, value, globals, record) != 0) {
+            // Unrecognised mapping type, entry skipped
+            continue;
         }
-        map_file.close();
+        emplace_entry(map_reg, record);
+    }
+}
+
+/**
+ * @brief Publish a new registry snapshot with one IDS replaced, m_load_mutex
+ * held
+ *
+ * The registry is copied (one pointer per IDS) rather than modified, readers
+ * holding the previous snapshot are unaffected.
+ *
+ * @param ids_str IDS name
+ * @param mappings new mappings, nullptr to remove the IDS
+ */
+void MappingHandler::publish(const std::string& ids_str,
+                             IDSMappingsPtr mappings) {
+
+    const auto current = std::atomic_load(&m_registry);
+    auto registry = current != nullptr
+                        ? std::make_shared<IDSMappingsStore_t>(*current)
+                        : std::make_shared<IDSMappingsStore_t>();
+    if (mappings != nullptr) {
+        registry->insert_or_assign(ids_str, std::move(mappings));
+    } else {
+        registry->erase(ids_str);
+    }
+    std::atomic_store(
+        &m_registry,
+        std::shared_ptr<const IDSMappingsStore_t>{std::move(registry)});
+    // After the swap, readers of the previous snapshot see a new generation
+    ++m_generation;
+}
+
+/**
+ * @brief Watch the mapping config and IDS directories, or the bundle
+ * directory (jmp_compile_bundle replaces the bundle by rename)
+ *
+ * @return int error_code
+ */
+int MappingHandler::start_watch() {
 
-        init_mappings(ids_str, temp_mappings);
+    int err = 0;
+    if (!m_bundle_path.empty()) {
+        const auto bundle_dir =
+            std::filesystem::path{m_bundle_path}.parent_path();
+        err = m_watcher.watch(bundle_dir.empty() ? "." : bundle_dir.string());
     } else {
-        RAISE_PLUGIN_ERROR(
-            "MappingHandler::load_mappings - Cannot open JSON mapping file");
+        err = m_watcher.watch(m_mapping_dir);
+        watch_ids_dirs();
+    }
+    if (err != 0 ||
+        m_watcher.start(
+            [this](const std::vector<std::string>& changed_paths) {
+                reload(changed_paths);
+            },
+            watch_settle) != 0) {
+        UDA_LOG(UDA_LOG_ERROR,
+                "\nMappingHandler::start_watch - Cannot watch mapping files\n");
+        return 1;
     }
     return 0;
 }
 
-int MappingHandler::init_mappings(const std::string& ids_name,
-                                  const nlohmann::json& data) {
+void MappingHandler::watch_ids_dirs() {
 
-    IDSMapRegister_t temp_map_reg;
-    for (const auto& [key, value] : data.items()) {
+    for (const auto& ids_str : listed_ids()) {
+        const auto ids_dir =
+            std::filesystem::path{m_mapping_dir} / "mappings" / ids_str;
+        if (std::filesystem::is_directory(ids_dir)) {
+            m_watcher.watch(ids_dir.string());
+        }
+    }
+}
 
-        switch (value["MAP_TYPE"].get<MapTransfos>()) {
-        case MapTransfos::VALUE: {
-            temp_map_reg.try_emplace(
-                key, std::make_unique<ValueEntry>(ValueEntry(value["VALUE"])));
-            break;
-        }
-        case MapTransfos::PLUGIN: {
-            // Structured bindings lambda capture bug, json passed as argument
-            auto get_offset_scale = [&](const std::string& var_str,
-                                        nlohmann::json value_local) {
-                std::optional<float> opt_float{std::nullopt};
-                if (value_local.contains(var_str) and
-                    !value_local[var_str].is_null()) {
-                    if (value_local[var_str].is_number_float()) {
-                        opt_float = value_local[var_str].get<float>();
-                    } else if (value_local[var_str].is_string()) {
-                        try {
-                            const auto post_inja_str = inja::render(
-                                value_local[var_str].get<std::string>(),
-                                m_ids_attributes[ids_name]);
-                            opt_float = std::stof(post_inja_str);
-                        } catch (const std::invalid_argument& e) {
-                            UDA_LOG(UDA_LOG_DEBUG,
-                                    "\nCannot convert OFFSET/SCALE string to "
-                                    "float\n");
-                        }
-                    }
-                }
-                return opt_float;
-            };
-            temp_map_reg.try_emplace(
-                key, std::make_unique<MapEntry>(MapEntry(
-                         std::make_pair(value["PLUGIN"].get<PluginType>(),
-                                        value["PLUGIN"].get<std::string>()),
-                         value["ARGS"].get<MapArgs_t>(),
-                         get_offset_scale("OFFSET", value),
-                         get_offset_scale("SCALE", value))));
-            break;
-        }
-        case MapTransfos::DIM: {
-            temp_map_reg.try_emplace(
-                key, std::make_unique<DimEntry>(
-                         DimEntry(value["DIM_PROBE"].get<std::string>())));
-            break;
-        }
-        case MapTransfos::SLICE: {
-            temp_map_reg.try_emplace(
-                key, std::make_unique<SliceEntry>(SliceEntry(
-                         value["SLICE_INDEX"].get<std::vector<std::string>>(),
-                         value["SIGNAL"].get<std::string>())));
-            break;
-        }
-        case MapTransfos::EXPR: {
-            temp_map_reg.try_emplace(
-                key,
-                std::make_unique<ExprEntry>(ExprEntry(
-                    value["EXPR"].get<std::string>(),
-                    value["PARAMETERS"]
-                        .get<std::unordered_map<std::string, std::string>>())));
-            break;
-        }
-        case MapTransfos::CUSTOM: {
-            temp_map_reg.try_emplace(
-                key, std::make_unique<CustomEntry>(CustomEntry(
-                         value["CUSTOM_TYPE"].get<CustomMapType_t>())));
-            break;
-        }
-        default:
-            break;
-            // RAISE_PLUGIN_ERROR("ImasMastuPlugin::init_mappings(...) "
-            // "Unrecognised mapping type");
-        }
-    }
-
-    m_ids_map_register.try_emplace(ids_name, std::move(temp_map_reg));
-    UDA_LOG(UDA_LOG_DEBUG, "calling read function \n");
+/**
+ * @brief Rebuild the IDSs whose mapping files changed, on the watcher thread
+ *
+ * A config or bundle change rebuilds every loaded IDS and drops IDSs no
+ * longer listed. IDSs not loaded yet (LAZY) are left to their first request.
+ * An IDS that fails to rebuild keeps its previous mappings.
+ *
+ * @param changed_paths files written or replaced, or watched directories
+ * after an event queue overflow
+ */
+void MappingHandler::reload(const std::vector<std::string>& changed_paths) {
 
-    return 0;
+    using JMP::logging::LogLevel;
+    namespace fs = std::filesystem;
+
+    // Held throughout, the paths and listener are read under the same lock
+    // their setters take
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    const auto bundle_path = normal_path(m_bundle_path);
+    const auto bundle_dir = normal_path(
+        bundle_path.has_parent_path() ? bundle_path.parent_path() : ".");
+    const auto mapping_dir = normal_path(m_mapping_dir);
+    const auto ids_root = mapping_dir / "mappings";
+
+    bool reload_all = false;
+    std::set<std::string, std::less<>> changed_ids;
+    for (const auto& changed : changed_paths) {
+        const auto path = normal_path(changed);
+        if (!m_bundle_path.empty()) {
+            reload_all |= path == bundle_path || path == bundle_dir;
+        } else if (path == mapping_dir / "mappings.cfg.json" ||
+                   path == mapping_dir) {
+            reload_all = true;
+        } else if (path.parent_path() == ids_root) {
+            // IDS directory, after an event queue overflow
+            changed_ids.insert(path.filename().string());
+        } else if (path.parent_path().parent_path() == ids_root) {
+            changed_ids.insert(path.parent_path().filename().string());
+        }
+    }
+    if (!reload_all && changed_ids.empty()) {
+        return;
+    }
+
+    const auto notify = [&](const std::string& ids_str) {
+        if (m_reload_listener) {
+            m_reload_listener(ids_str);
+        }
+    };
+
+    if (reload_all) {
+        std::string error;
+        if (!m_bundle_path.empty()) {
+            // Check the new bundle before unmapping the current one
+            JMP::bundle::MappingBundle candidate;
+            if (candidate.open(m_bundle_path, error) != 0) {
+                JMP::logging::log(LogLevel::ERROR,
+                                  "MappingHandler::reload - previous mappings "
+                                  "kept, " + error);
+                return;
+            }
+        }
+        if (load_config(error) != 0) {
+            JMP::logging::log(LogLevel::ERROR,
+                              "MappingHandler::reload - previous mappings "
+                              "kept, " + error);
+            return;
+        }
+        if (m_bundle_path.empty()) {
+            watch_ids_dirs();
+        }
+        for (auto ids_it = m_loaded_ids.begin();
+             ids_it != m_loaded_ids.end();) {
+            if (ids_listed(*ids_it)) {
+                ++ids_it;
+                continue;
+            }
+            publish(*ids_it, nullptr);
+            notify(*ids_it);
+            ids_it = m_loaded_ids.erase(ids_it);
+        }
+        if (m_load_mode == LoadMode::EAGER) {
+            for (auto& ids_str : listed_ids()) {
+                m_loaded_ids.insert(std::move(ids_str));
+            }
+        }
+        changed_ids = m_loaded_ids;
+    }
+
+    for (const auto& ids_str : changed_ids) {
+        if (m_loaded_ids.find(ids_str) == m_loaded_ids.end()) {
+            continue;
+        }
+        auto mappings = std::make_shared<IDSMappings>();
+        std::string error;
+        if (build_ids(ids_str, *mappings, error) != 0) {
+            JMP::logging::log(LogLevel::ERROR,
+                              "MappingHandler::reload - previous " + ids_str +
+                                  " mappings kept, " + error);
+            // Never built, left to be loaded again on request
+            const auto registry = std::atomic_load(&m_registry);
+            if (registry == nullptr || registry->count(ids_str) == 0) {
+                m_loaded_ids.erase(ids_str);
+            }
+            continue;
+        }
+        publish(ids_str, std::move(mappings));
+        notify(ids_str);
+        JMP::logging::log(LogLevel::INFO,
+                          "MappingHandler::reload - reloaded " + ids_str);
+    }
 }
@@ -1,54 +1,125 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
+#include "handlers/map_register.hpp"
+#include "handlers/mapping_bundle.hpp"
 #include "map_types/base_entry.hpp"
+#include "utils/file_watcher.hpp"
 #include <nlohmann/json.hpp>
 
-using IDSMapRegister_t =
-    std::unordered_map<std::string, std::unique_ptr<Mapping>>;
-using IDSMapRegisterStore_t = std::unordered_map<std::string, IDSMapRegister_t>;
-using IDSAttrRegisterStore_t = std::unordered_map<std::string, nlohmann::json>;
-using MappingPair = std::pair<nlohmann::json&, IDSMapRegister_t&>;
+using IDSMapRegister_t = IDSMapRegister;
 
+/**
+ * @brief Globals and mapping entries of one IDS, immutable once published
+ */
+struct IDSMappings {
+    nlohmann::json globals;
+    IDSMapRegister_t entries;
+};
+using IDSMappingsPtr = std::shared_ptr<const IDSMappings>;
+// Ordered with transparent comparison, looked up by std::string_view
+using IDSMappingsStore_t = std::map<std::string, IDSMappingsPtr, std::less<>>;
+
+/**
+ * @brief When the IDS mapping files are read and parsed
+ *
+ * EAGER: every IDS listed in mappings.cfg.json is loaded on init
+ * LAZY: an IDS is loaded on the first request for it
+ */
+enum class LoadMode { EAGER, LAZY };
+
+/**
+ * @class MappingHandler
+ * @brief Loads and owns the mappings of every IDS
+ *
+ * The loaded IDSs form an immutable registry snapshot, replaced as a whole
+ * (copy-on-write, atomic pointer swap) whenever an IDS is loaded or
+ * reloaded. Requests hold the IDSMappings they started with, so a reload
+ * never changes the mappings under an in-flight request and the previous
+ * version is freed when its last request finishes.
+ *
+ * With watching enabled the mapping files (or the bundle) are watched with
+ * inotify and only the IDSs whose files changed are rebuilt, on the watcher
+ * thread. A failed rebuild keeps the previous version.
+ */
 class MappingHandler {
 
   public:
+    // Called on the watcher thread after an IDS has been reloaded
+    using ReloadListener_t = std::function<void(std::string_view ids)>;
+
     MappingHandler() : m_init(false), m_imas_version("3.37"){};
     explicit MappingHandler(std::string imas_version)
         : m_init(false), m_imas_version(std::move(imas_version)){};
-    ~MappingHandler() {
-        m_ids_attributes.clear();
-        m_ids_map_register.clear();
-        m_mapping_config.clear();
-        m_init = false;
-    }
-    int init() {
-        if (m_init || !m_ids_map_register.empty()) {
-            return 0;
-        }
-        load_all();
-
-        m_init = true;
-        return 0;
-    };
+    ~MappingHandler() { reset(); }
+    int init();
+    int reset();
     int set_map_dir(const std::string& mapping_dir);
-    MappingPair read_mappings(const std::string& request_ids);
+    int set_bundle_path(const std::string& bundle_path);
+    int set_load_mode(LoadMode load_mode);
+    int set_watch(bool watch);
+    void set_reload_listener(ReloadListener_t listener);
+    IDSMappingsPtr read_mappings(std::string_view request_ids);
+    IDSMappingsPtr read_mappings(std::string_view request_ids,
+                                 uint64_t& generation);
+    // Incremented whenever the registry is replaced (load, reload, reset)
+    [[nodiscard]] uint64_t generation() const { return m_generation; }
 
   private:
-    int init_mappings(const std::string& ids_name, const nlohmann::json& data);
+    int load_config(std::string& error);
     int load_all();
-    int load_globals(const std::string& ids_str);
-    int load_mappings(const std::string& ids_str);
+    int load_ids(std::string_view ids_str);
+    [[nodiscard]] bool ids_listed(std::string_view ids_str) const;
+    [[nodiscard]] std::vector<std::string> listed_ids() const;
+    int build_ids(const std::string& ids_str, IDSMappings& mappings,
+                  std::string& error) const;
+    int load_bundle_ids(const std::string& ids_str, IDSMappings& mappings,
+                        std::string& error) const;
+    static void init_mappings(const nlohmann::json& data,
+                              const nlohmann::json& globals,
+                              IDSMapRegister_t& map_reg);
+    void publish(const std::string& ids_str, IDSMappingsPtr mappings);
+    int start_watch();
+    void watch_ids_dirs();
+    void reload(const std::vector<std::string>& changed_paths);
 
-    IDSMapRegisterStore_t m_ids_map_register;
-    IDSAttrRegisterStore_t m_ids_attributes;
+    // Current registry snapshot, read and replaced with std::atomic_load and
+    // std::atomic_store
+    std::shared_ptr<const IDSMappingsStore_t> m_registry;
+    std::atomic<uint64_t> m_generation{0};
+    // Serialises loads and publishes, request (LAZY) and watcher threads,
+    // and guards the configuration the watcher thread reads
+    std::mutex m_load_mutex;
+    // IDSs built and published, failed loads are not recorded
+    std::set<std::string, std::less<>> m_loaded_ids;
+    // Returned for IDSs without mappings
+    const IDSMappingsPtr m_empty_mappings{std::make_shared<IDSMappings>()};
+    LoadMode m_load_mode{LoadMode::EAGER};
     bool m_init;
 
     std::string m_imas_version;
     std::string m_mapping_dir;
     nlohmann::json m_mapping_config;
+    // Precompiled bundle, replaces the mapping directory when set
+    std::string m_bundle_path;
+    JMP::bundle::MappingBundle m_bundle;
+
+    bool m_watch{false};
+    // Quiet time after the last file event before reloading, editors and
+    // copies write a file in several steps
+    static constexpr std::chrono::milliseconds watch_settle{200};
+    JMP::watch::FileWatcher m_watcher;
+    ReloadListener_t m_reload_listener;
 };
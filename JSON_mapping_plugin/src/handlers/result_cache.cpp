@@ -0,0 +1,269 @@
+#include "handlers/result_cache.hpp"
+#include "utils/uda_plugin_helpers.hpp"
+
+#include <clientserver/initStructs.h>
+#include <cstdlib>
+#include <cstring>
+
+namespace JMP::cache {
+
+namespace {
+
+void copy_string(char* dest, const std::string& source) {
+    strncpy(dest, source.c_str(), STRING_LENGTH - 1);
+    dest[STRING_LENGTH - 1] = '\0';
+}
+
+} // namespace
+
+/**
+ * @brief Set the memory budget and time to live, shrinking the cache if
+ * needed
+ *
+ * @param max_bytes payload budget in bytes, 0 disables the cache
+ * @param ttl entry lifetime, 0 for no expiry
+ */
+void ResultCache::configure(size_t max_bytes, std::chrono::seconds ttl) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_bytes = max_bytes;
+    m_ttl = ttl;
+    evict_to(m_max_bytes);
+}
+
+/**
+ * @brief Cache key of a resolved request
+ *
+ * @param element full IDS element path
+ * @param request request context
+ * @return std::string key
+ */
+std::string ResultCache::make_key(std::string_view element,
+                                  const RequestContext& request) {
+
+    std::string key{element};
+    key += '\n';
+    key += request.host;
+    key += ':';
+    key += std::to_string(request.port);
+    key += '\n';
+    key += std::to_string(request.shot);
+    key += '\n';
+    for (const auto index : request.indices) {
+        key += std::to_string(index);
+        key += ',';
+    }
+    key += '\n';
+    key += std::to_string(static_cast<int>(request.sig_type));
+    return key;
+}
+
+/**
+ * @brief Whether an unexpired result is cached, counters and LRU order are
+ * left untouched
+ *
+ * @param key request key
+ * @return true if restore would hit
+ */
+bool ResultCache::contains(const std::string& key) const {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto found = m_index.find(key);
+    return found != m_index.end() &&
+           (m_ttl.count() == 0 ||
+            Clock_t::now() - found->second->stored <= m_ttl);
+}
+
+/**
+ * @brief Fill data_block from a cached result
+ *
+ * @param key request key
+ * @param data_block data_block to fill, newly allocated arrays owned by
+ * the data_block
+ * @return true on a hit
+ */
+bool ResultCache::restore(const std::string& key, DATA_BLOCK* data_block) {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto found = m_index.find(key);
+    if (found == m_index.end()) {
+        ++m_stats.misses;
+        return false;
+    }
+    auto entry = found->second;
+    if (m_ttl.count() > 0 && Clock_t::now() - entry->stored > m_ttl) {
+        erase(entry);
+        ++m_stats.misses;
+        return false;
+    }
+    // Move to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, entry);
+    ++m_stats.hits;
+
+    initDataBlock(data_block);
+    data_block->data_type = entry->data_type;
+    data_block->data_n = entry->data_n;
+    data_block->rank = entry->rank;
+    data_block->order = entry->order;
+    data_block->data = static_cast<char*>(malloc(entry->data.size()));
+    std::copy(entry->data.begin(), entry->data.end(), data_block->data);
+    copy_string(data_block->data_units, entry->units);
+    copy_string(data_block->data_label, entry->label);
+    copy_string(data_block->data_desc, entry->desc);
+
+    if (!entry->dims.empty()) {
+        data_block->dims =
+            static_cast<DIMS*>(malloc(entry->dims.size() * sizeof(DIMS)));
+        for (size_t i = 0; i < entry->dims.size(); ++i) {
+            const auto& cached_dim = entry->dims[i];
+            DIMS* dim = &data_block->dims[i];
+            initDimBlock(dim);
+            dim->data_type = cached_dim.data_type;
+            dim->dim_n = cached_dim.dim_n;
+            dim->compressed = cached_dim.compressed;
+            dim->dim0 = cached_dim.dim0;
+            dim->diff = cached_dim.diff;
+            dim->method = cached_dim.method;
+            if (!cached_dim.dim.empty()) {
+                dim->dim = static_cast<char*>(malloc(cached_dim.dim.size()));
+                std::copy(cached_dim.dim.begin(), cached_dim.dim.end(),
+                          dim->dim);
+            }
+            copy_string(dim->dim_units, cached_dim.units);
+            copy_string(dim->dim_label, cached_dim.label);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copy a mapped result into the cache
+ *
+ * @param key request key
+ * @param data_block successfully mapped data_block, left untouched
+ * @param still_valid checked under the cache lock right before inserting,
+ * nothing is cached if it returns false. Invalidations (erase_prefix) take
+ * the same lock, so a result cannot be stored after its invalidation.
+ * @return true if cached, false if disabled, not cacheable, larger than
+ * the budget or no longer valid
+ */
+bool ResultCache::store(const std::string& key, const DATA_BLOCK* data_block,
+                        const std::function<bool()>& still_valid) {
+
+    if (!enabled() || data_block->data == nullptr ||
+        data_block->errhi != nullptr || data_block->errlo != nullptr ||
+        data_block->opaque_block != nullptr) {
+        return false;
+    }
+    const auto type_size =
+        imas_json_plugin::uda_helpers::uda_type_size(data_block->data_type);
+    if (type_size == 0) {
+        return false;
+    }
+
+    CachedResult result;
+    result.key = key;
+    result.data_type = data_block->data_type;
+    result.data_n = data_block->data_n;
+    result.rank = data_block->rank;
+    result.order = data_block->order;
+    result.data.assign(data_block->data,
+                       data_block->data + data_block->data_n * type_size);
+    result.units = data_block->data_units;
+    result.label = data_block->data_label;
+    result.desc = data_block->data_desc;
+    result.bytes = key.size() + result.data.size() + sizeof(CachedResult);
+
+    if (data_block->dims != nullptr) {
+        result.dims.reserve(data_block->rank);
+        for (unsigned int i = 0; i < data_block->rank; ++i) {
+            const DIMS& dim = data_block->dims[i];
+            if (dim.errhi != nullptr || dim.errlo != nullptr ||
+                (dim.compressed && dim.method != 0)) {
+                return false;
+            }
+            CachedDim cached_dim;
+            cached_dim.data_type = dim.data_type;
+            cached_dim.dim_n = dim.dim_n;
+            cached_dim.compressed = dim.compressed;
+            cached_dim.dim0 = dim.dim0;
+            cached_dim.diff = dim.diff;
+            cached_dim.method = dim.method;
+            cached_dim.units = dim.dim_units;
+            cached_dim.label = dim.dim_label;
+            if (!dim.compressed) {
+                const auto dim_size =
+                    imas_json_plugin::uda_helpers::uda_type_size(
+                        dim.data_type);
+                if (dim.dim == nullptr || dim_size == 0) {
+                    return false;
+                }
+                cached_dim.dim.assign(dim.dim, dim.dim + dim.dim_n * dim_size);
+            }
+            result.bytes += cached_dim.dim.size() + sizeof(CachedDim);
+            result.dims.push_back(std::move(cached_dim));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t max_bytes{m_max_bytes};
+    if (result.bytes > max_bytes || (still_valid && !still_valid())) {
+        return false;
+    }
+    const auto found = m_index.find(key);
+    if (found != m_index.end()) {
+        erase(found->second);
+    }
+    evict_to(max_bytes - result.bytes);
+    result.stored = Clock_t::now();
+    m_stats.bytes += result.bytes;
+    m_lru.push_front(std::move(result));
+    m_index.emplace(m_lru.front().key, m_lru.begin());
+    ++m_stats.insertions;
+    return true;
+}
+
+/**
+ * @brief Drop every entry whose key starts with prefix, eg. the results of
+ * one IDS after its mappings are reloaded
+ *
+ * @param prefix key prefix, IDS name followed by '/'
+ */
+void ResultCache::erase_prefix(std::string_view prefix) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto entry = m_lru.begin(); entry != m_lru.end();) {
+        const auto next = std::next(entry);
+        if (std::string_view{entry->key}.substr(0, prefix.size()) == prefix) {
+            erase(entry);
+        }
+        entry = next;
+    }
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_lru.clear();
+    m_stats.bytes = 0;
+}
+
+CacheStats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CacheStats stats{m_stats};
+    stats.entries = m_lru.size();
+    return stats;
+}
+
+void ResultCache::erase(LRUList_t::iterator entry) {
+    m_stats.bytes -= entry->bytes;
+    m_index.erase(entry->key);
+    m_lru.erase(entry);
+}
+
+void ResultCache::evict_to(size_t max_bytes) {
+    while (!m_lru.empty() && m_stats.bytes > max_bytes) {
+        erase(std::prev(m_lru.end()));
+        ++m_stats.evictions;
+    }
+}
+
+} // namespace JMP::cache
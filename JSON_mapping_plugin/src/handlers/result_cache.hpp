@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <clientserver/udaStructs.h>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "map_types/base_entry.hpp"
+
+namespace JMP::cache {
+
+struct CacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t insertions{0};
+    uint64_t evictions{0};
+    size_t entries{0};
+    size_t bytes{0};
+};
+
+/**
+ * @class ResultCache
+ * @brief Bounded cache of mapped request results
+ *
+ * Stores a copy of the DATA_BLOCK payload (data, dimensions, labels)
+ * produced for a resolved request, keyed on the IDS element path, data
+ * source, shot, indices and signal type. Entries are evicted least recently
+ * used first once the memory budget is exceeded, and expire after the time
+ * to live. Only atomic data with plain or method 0 compressed dimensions and
+ * no error arrays is cached, anything else is always recomputed.
+ *
+ * A short-lived instance without expiry also serves as the per-request
+ * memo of raw plugin results, keyed on the plugin request string.
+ */
+class ResultCache {
+  public:
+    using Clock_t = std::chrono::steady_clock;
+
+    void configure(size_t max_bytes, std::chrono::seconds ttl);
+    [[nodiscard]] bool enabled() const { return m_max_bytes > 0; }
+
+    static std::string make_key(std::string_view element,
+                                const RequestContext& request);
+
+    [[nodiscard]] bool contains(const std::string& key) const;
+    bool restore(const std::string& key, DATA_BLOCK* data_block);
+    bool store(const std::string& key, const DATA_BLOCK* data_block,
+               const std::function<bool()>& still_valid = {});
+    void erase_prefix(std::string_view prefix);
+    void clear();
+    [[nodiscard]] CacheStats stats() const;
+
+  private:
+    struct CachedDim {
+        int data_type{0};
+        int dim_n{0};
+        int compressed{0};
+        double dim0{0.0};
+        double diff{0.0};
+        int method{0};
+        std::vector<char> dim; // empty when compressed
+        std::string units;
+        std::string label;
+    };
+
+    struct CachedResult {
+        std::string key;
+        Clock_t::time_point stored;
+        size_t bytes{0};
+        int data_type{0};
+        int data_n{0};
+        unsigned int rank{0};
+        int order{-1};
+        std::vector<char> data;
+        std::vector<CachedDim> dims;
+        std::string units;
+        std::string label;
+        std::string desc;
+    };
+
+    using LRUList_t = std::list<CachedResult>;
+
+    void erase(LRUList_t::iterator entry);
+    void evict_to(size_t max_bytes);
+
+    std::atomic<size_t> m_max_bytes{0};
+    std::chrono::seconds m_ttl{0};
+    // Most recently used first
+    LRUList_t m_lru;
+    std::unordered_map<std::string_view, LRUList_t::iterator> m_index;
+    CacheStats m_stats;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace JMP::cache
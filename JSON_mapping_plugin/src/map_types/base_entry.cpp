@@ -2,68 +2,19 @@
 #include "utils/uda_plugin_helpers.hpp"
 
 #include <algorithm>
-#include <boost/algorithm/string.hpp>
-#include <inja/inja.hpp>
+#include <clientserver/freeDataBlock.h>
 #include <unordered_map>
 
 /**
- * @brief
- *
- * @param nvlist
- * @return
- */
-int Mapping::set_current_request_data_map(
-    std::unordered_map<std::string, std::string>& nvlist) {
-
-    //////////////////////////////////////////////////////////////
-    //////////////////////////////////////////////////////////////
-    if (nvlist.empty()) {
-        return 1;
-    }
-
-    int err{0};
-    std::vector<int> vec_indices;
-    std::vector<std::string> vec_indices_str;
-    boost::split(vec_indices_str, nvlist.at("indices"), boost::is_any_of(";"));
-    // Subtract 1 from each indices element, IMAS is 1-based
-    // and other machines (MAST-intU for example) are zero-based
-    std::for_each(vec_indices_str.begin(), vec_indices_str.end(),
-                  [&](std::string& i_str) {
-                      try {
-                          // Subtract 1 from each indices element, IMAS is
-                          // 1-based and other machines (MAST-U for example) are
-                          // zero-based
-                          vec_indices.push_back(std::stoi(i_str) - 1);
-                          err = 0;
-                      } catch (const std::invalid_argument& e) {
-                          UDA_LOG(
-                              UDA_LOG_DEBUG,
-                              "\nMapping::set_current_request_data_map - %s -"
-                              "Cannot convert string indices to int\n",
-                              e.what());
-                          err = 1;
-                      }
-                  });
-
-    // Set request info
-    // Replace hardcoded values after IMAS-plugin request change
-    m_request_data.host = "uda2.hpc.l";
-    m_request_data.port = 56565;
-    m_request_data.shot = std::stoi(nvlist.at("shot")); // ask forgiveness
-    m_request_data.indices = vec_indices;
-    m_request_data.sig_type = SignalType::DEFAULT;
-    //////////////////////////////////////////////////////////////
-    //////////////////////////////////////////////////////////////
-
-    return err;
-}
-/**
- * @brief
+ * @brief Build the request context from the plugin request name-value list
  *
- * @param nvlist
- * @return
+ * @param nvlist request name-value list (shot, indices required)
+ * @param sig_type signal type deduced from the IDS path
+ * @param request [out] request context
+ * @return int error_code
  */
-int Mapping::set_current_request_data(NAMEVALUELIST* nvlist) {
+int make_request_context(const NAMEVALUELIST* nvlist, SignalType sig_type,
+                         RequestContext& request) {
 
     //////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////
@@ -91,30 +42,70 @@ int Mapping::set_current_request_data(NAMEVALUELIST* nvlist) {
 
     // Set request info
     // Replace hardcoded values after IMAS-plugin request change
-    m_request_data.host = "uda2.hpc.l";
-    m_request_data.port = 56565;
-    m_request_data.shot = shot;
-    m_request_data.indices = vec_indices;
-    m_request_data.sig_type = SignalType::DEFAULT;
+    request.host = "uda2.hpc.l";
+    request.port = 56565;
+    request.shot = shot;
+    request.indices = std::move(vec_indices);
+    request.sig_type = sig_type;
     //////////////////////////////////////////////////////////////
     //////////////////////////////////////////////////////////////
 
     return 0;
 }
 
+/**
+ * @brief Shape of the data the mapping returns, without returning it
+ *
+ * Default: the mapping is evaluated into a scratch data_block and only its
+ * dimensions are kept. Entries able to derive their shape without
+ * materialising the data override this.
+ *
+ * @param interface IDAM_PLUGIN_INTERFACE, its data_block is left untouched
+ * @param entries IDS mapping register
+ * @param global_data global JSON object used in templating
+ * @param request immutable request context
+ * @param shape [out] dimension lengths in UDA dims order, empty for scalars
+ * @return int error_code
+ */
+int Mapping::shape(IDAM_PLUGIN_INTERFACE* interface,
+                   const IDSMapRegister& entries,
+                   const nlohmann::json& global_data,
+                   const RequestContext& request,
+                   std::vector<size_t>& shape) const {
+
+    DATA_BLOCK scratch_block;
+    initDataBlock(&scratch_block);
+    IDAM_PLUGIN_INTERFACE scratch_interface{*interface};
+    scratch_interface.data_block = &scratch_block;
+
+    const int err = map(&scratch_interface, entries, global_data, request);
+    shape.clear();
+    if (!err) {
+        if (scratch_block.rank > 0 && scratch_block.dims != nullptr) {
+            for (unsigned int i = 0; i < scratch_block.rank; ++i) {
+                shape.push_back(scratch_block.dims[i].dim_n);
+            }
+        } else if (scratch_block.data_n != 1) {
+            shape.push_back(std::max(scratch_block.data_n, 0));
+        }
+    }
+    freeDataBlock(&scratch_block);
+    return err;
+}
+
 /**
  * @brief
  *
  * @param interface
  * @param entries
  * @param global_data
- * @param sig_type
+ * @param request
  * @return
  */
-int ValueEntry::map(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& global_data) const {
+int ValueEntry::map(IDAM_PLUGIN_INTERFACE* interface,
+                    const IDSMapRegister& entries,
+                    const nlohmann::json& global_data,
+                    const RequestContext& request) const {
 
     const auto temp_val = m_value;
     if (temp_val.is_discarded() or temp_val.is_binary() or temp_val.is_null()) {
@@ -144,6 +135,54 @@ int ValueEntry::map(
     return err;
 };
 
+/**
+ * @brief Shape of the value, numbers and arrays of numbers are answered
+ * from the JSON directly
+ *
+ * @param shape [out] {array length}, empty for a scalar
+ * @return int error_code
+ */
+int ValueEntry::shape(IDAM_PLUGIN_INTERFACE* interface,
+                      const IDSMapRegister& entries,
+                      const nlohmann::json& global_data,
+                      const RequestContext& request,
+                      std::vector<size_t>& shape) const {
+
+    shape.clear();
+    if (m_value.is_array()) {
+        const bool all_number = std::all_of(
+            m_value.begin(), m_value.end(),
+            [](const nlohmann::json& els) { return els.is_number(); });
+        if (!all_number || m_value.empty()) {
+            return 1;
+        }
+        shape.push_back(m_value.size());
+        return 0;
+    }
+    if (m_value.is_number() || m_value.is_boolean()) {
+        return 0;
+    }
+    // Templated strings may render to a number or a string
+    return Mapping::shape(interface, entries, global_data, request, shape);
+}
+
+/**
+ * @brief Convert a JSON array of numbers straight into the data_block array
+ */
+template <typename T>
+static int write_json_array(DATA_BLOCK* data_block,
+                            const nlohmann::json& values) {
+
+    T* data = imas_json_plugin::uda_helpers::allocReturnDataArray<T>(
+        data_block, values.size());
+    if (data == nullptr) {
+        return 1;
+    }
+    std::transform(values.begin(), values.end(), data,
+                   [](const nlohmann::json& value) { return value.get<T>(); });
+    return 0;
+}
+
 /**
  * @brief
  *
@@ -155,32 +194,18 @@ int ValueEntry::type_deduc_array(DATA_BLOCK* data_block,
                                  const nlohmann::json& temp_val) const {
 
     switch (temp_val.front().type()) {
-    case nlohmann::json::value_t::number_float: {
+    case nlohmann::json::value_t::number_float:
         // Handle array of floats
-        auto temp_vec = temp_val.get<std::vector<float>>();
-        imas_json_plugin::uda_helpers::setReturnDataArrayType_Vec<float>(
-            data_block, temp_vec);
-        break;
-    }
-    case nlohmann::json::value_t::number_integer: {
+        return write_json_array<float>(data_block, temp_val);
+    case nlohmann::json::value_t::number_integer:
         // Handle array of ints
-        auto temp_vec = temp_val.get<std::vector<int>>();
-        imas_json_plugin::uda_helpers::setReturnDataArrayType_Vec<int>(
-            data_block, temp_vec);
-        break;
-    }
-    case nlohmann::json::value_t::number_unsigned: {
+        return write_json_array<int>(data_block, temp_val);
+    case nlohmann::json::value_t::number_unsigned:
         // Handle array of ints
-        auto temp_vec = temp_val.get<std::vector<unsigned int>>();
-        imas_json_plugin::uda_helpers::setReturnDataArrayType_Vec<unsigned int>(
-            data_block, temp_vec);
-        break;
-    }
+        return write_json_array<unsigned int>(data_block, temp_val);
     default:
         return 1;
     }
-
-    return 0;
 }
 
 /**
@@ -212,16 +237,14 @@ int ValueEntry::type_deduc_prim(DATA_BLOCK* data_block,
             data_block, temp_val.get<unsigned int>(), nullptr);
         break;
     case nlohmann::json::value_t::boolean:
-        // Handle bool
-        imas_json_plugin::uda_helpers::setReturnDataScalarType<bool>(
-            data_block, temp_val.get<bool>(), nullptr);
+        // Handle bool, UDA has no boolean type
+        imas_json_plugin::uda_helpers::setReturnDataScalarType<int>(
+            data_block, temp_val.get<bool>() ? 1 : 0, nullptr);
         break;
     case nlohmann::json::value_t::string: {
         // Handle string
-        // Double inja template execution
-        std::string post_inja_str{
-            inja::render(inja::render(temp_val.get<std::string>(), global_data),
-                         global_data)};
+        // Template parsed at load, only rendered here
+        std::string post_inja_str{m_value_template->render(global_data)};
         // try to convert to integer
         // catch exception - output as string
         // inja templating may replace with number
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <clientserver/udaStructs.h>
+#include <functional>
 #include <nlohmann/json.hpp>
+#include <numeric>
+#include <optional>
 #include <plugins/pluginStructs.h>
 #include <plugins/udaPlugin.h>
 
+#include "utils/template_string.hpp"
+
 enum class MapTransfos { VALUE, PLUGIN, SLICE, EXPR, CUSTOM, DIM };
 
 NLOHMANN_JSON_SERIALIZE_ENUM(MapTransfos, {{MapTransfos::VALUE, "VALUE"},
@@ -16,48 +21,84 @@ NLOHMANN_JSON_SERIALIZE_ENUM(MapTransfos, {{MapTransfos::VALUE, "VALUE"},
 
 enum class SignalType { DEFAULT, DATA, TIME, ERROR, DIM, INVALID };
 
+namespace JMP::cache {
+class ResultCache;
+}
+
+/**
+ * @brief Immutable per-request data (shot, source location, IDS indices and
+ * signal type), passed down through every mapping evaluation
+ *
+ * Mapping entries hold no request state, the loaded registry can be shared
+ * read-only between concurrent requests.
+ */
+struct RequestContext {
+    std::string host;
+    int port{0};
+    int shot{0};
+    std::vector<int> indices;
+    SignalType sig_type{SignalType::DEFAULT};
+    // Raw plugin results of this request keyed by request string, shared by
+    // every entry fetching the same signal, not owned (nullptr: no memo)
+    JMP::cache::ResultCache* memo{nullptr};
+    // Raw plugin results fetched ahead of the request by prefetch, keyed by
+    // request string, not owned (nullptr: not consulted)
+    JMP::cache::ResultCache* prefetched{nullptr};
+
+    [[nodiscard]] RequestContext with_sig_type(SignalType new_sig_type) const {
+        RequestContext request{*this};
+        request.sig_type = new_sig_type;
+        return request;
+    }
+};
+
+int make_request_context(const NAMEVALUELIST* nvlist, SignalType sig_type,
+                         RequestContext& request);
+
+class IDSMapRegister;
+
+/**
+ * @brief Number of elements of a shape, 1 for scalars (empty shape)
+ */
+inline size_t shape_count(const std::vector<size_t>& shape) {
+    return std::accumulate(shape.begin(), shape.end(), size_t{1},
+                           std::multiplies<>());
+}
+
 class Mapping {
   public:
     Mapping() = default;
     virtual ~Mapping() = default;
     virtual int map(IDAM_PLUGIN_INTERFACE* interface,
-                    const std::unordered_map<std::string,
-                                             std::unique_ptr<Mapping>>& entries,
-                    const nlohmann::json& global_data) const = 0;
-    [[nodiscard]] std::vector<int> get_current_indices() const {
-        return m_request_data.indices;
-    }
-    int set_current_request_data(NAMEVALUELIST* nvlist);
-    int set_current_request_data_map(
-        std::unordered_map<std::string, std::string>& nvlist);
-    int set_sig_type(SignalType sig_type) {
-        m_request_data.sig_type = sig_type;
-        return 0;
-    };
-
-  protected:
-    struct RequestStruct {
-        std::string host;
-        int port;
-        int shot;
-        std::vector<int> indices;
-        SignalType sig_type;
-    };
-    RequestStruct m_request_data;
+                    const IDSMapRegister& entries,
+                    const nlohmann::json& global_data,
+                    const RequestContext& request) const = 0;
+    virtual int shape(IDAM_PLUGIN_INTERFACE* interface,
+                      const IDSMapRegister& entries,
+                      const nlohmann::json& global_data,
+                      const RequestContext& request,
+                      std::vector<size_t>& shape) const;
 };
 
 class ValueEntry : public Mapping {
   public:
     ValueEntry() = delete;
     ~ValueEntry() override = default;
-    explicit ValueEntry(nlohmann::json value) : m_value{std::move(value)} {};
-    int map(IDAM_PLUGIN_INTERFACE* interface,
-            const std::unordered_map<std::string, std::unique_ptr<Mapping>>&
-                entries,
-            const nlohmann::json& global_data) const override;
+    explicit ValueEntry(nlohmann::json value) : m_value(std::move(value)) {
+        if (m_value.is_string()) {
+            m_value_template.emplace(m_value.get<std::string>());
+        }
+    };
+    int map(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+            const nlohmann::json& global_data,
+            const RequestContext& request) const override;
+    int shape(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+              const nlohmann::json& global_data, const RequestContext& request,
+              std::vector<size_t>& shape) const override;
 
   private:
     nlohmann::json m_value;
+    std::optional<JMP::templating::TemplateString> m_value_template;
     int type_deduc_array(DATA_BLOCK* data_block,
                          const nlohmann::json& arrValue) const;
     int type_deduc_prim(DATA_BLOCK* data_block, const nlohmann::json& numValue,
@@ -10,12 +10,13 @@
  * @param entries unordered map of all mappings loaded for this experiment and
  * IDS
  * @param global_data global JSON object used in templating
+ * @param request immutable request context
  * @return int error_code
  */
-int CustomEntry::map(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& global_data) const {
+int CustomEntry::map(IDAM_PLUGIN_INTERFACE* interface,
+                     const IDSMapRegister& entries,
+                     const nlohmann::json& global_data,
+                     const RequestContext& request) const {
 
     int err{1};
     switch (m_custom_type) {
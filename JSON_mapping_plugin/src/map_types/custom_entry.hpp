@@ -22,10 +22,9 @@ class CustomEntry : public Mapping {
     ~CustomEntry() override = default;
     explicit CustomEntry(CustomMapType_t custom_type)
         : m_custom_type(custom_type){};
-    int map(IDAM_PLUGIN_INTERFACE* interface,
-            const std::unordered_map<std::string, std::unique_ptr<Mapping>>&
-                entries,
-            const nlohmann::json& global_data) const override;
+    int map(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+            const nlohmann::json& global_data,
+            const RequestContext& request) const override;
 
   private:
     CustomMapType_t m_custom_type;
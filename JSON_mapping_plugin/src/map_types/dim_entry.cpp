@@ -1,29 +1,32 @@
 #include "map_types/dim_entry.hpp"
+#include "handlers/map_register.hpp"
 #include "map_types/base_entry.hpp"
 #include <clientserver/udaStructs.h>
+#include <vector>
 
-int DimEntry::map(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& json_globals) const {
+int DimEntry::map(IDAM_PLUGIN_INTERFACE* interface,
+                  const IDSMapRegister& entries,
+                  const nlohmann::json& json_globals,
+                  const RequestContext& request) const {
 
-    if (!entries.count(m_dim_probe)) {
+    const auto* dim_probe = entries.find(m_dim_probe);
+    if (dim_probe == nullptr) {
         return 1;
     }
-    // 0 if both successful
-    int err = entries.at(m_dim_probe)->set_sig_type(SignalType::DIM) or
-              entries.at(m_dim_probe)->map(interface, entries, json_globals);
-    if (!err) {
-        free((void*)interface->data_block->data); // fix
-        interface->data_block->data = nullptr;
-        if (!interface->data_block->data_n) {
-            UDA_LOG(
-                UDA_LOG_DEBUG,
+    // Shape only, the probe data is not materialised where avoidable
+    std::vector<size_t> probe_shape;
+    const int err =
+        dim_probe->shape(interface, entries, json_globals,
+                         request.with_sig_type(SignalType::DIM), probe_shape);
+    if (err) {
+        return err;
+    }
+    const auto count = shape_count(probe_shape);
+    if (count == 0) {
+        UDA_LOG(UDA_LOG_DEBUG,
                 "\nDimEntry::map: Dim probe could not be used for Shape_of \n");
-            return 1;
-        }
-        setReturnDataIntScalar(interface->data_block,
-                               interface->data_block->data_n, nullptr);
+        return 1;
     }
-    return err;
+    return setReturnDataIntScalar(interface->data_block,
+                                  static_cast<int>(count), nullptr);
 };
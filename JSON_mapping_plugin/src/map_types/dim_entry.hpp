@@ -8,10 +8,9 @@ class DimEntry : public Mapping {
     explicit DimEntry(std::string dim_probe)
         : m_dim_probe{std::move(dim_probe)} {};
 
-    int map(IDAM_PLUGIN_INTERFACE* interface,
-            const std::unordered_map<std::string, std::unique_ptr<Mapping>>&
-                entries,
-            const nlohmann::json& json_globals) const override;
+    int map(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+            const nlohmann::json& json_globals,
+            const RequestContext& request) const override;
 
   private:
     std::string m_dim_probe;
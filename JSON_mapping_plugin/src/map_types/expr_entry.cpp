@@ -1,29 +1,117 @@
 #include "map_types/expr_entry.hpp"
+#include "handlers/map_register.hpp"
 
-template int ExprEntry::eval_expr<float>(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& global_data) const;
+#include <structures/struct.h>
 
-// template int ExprEntry::eval_expr<double>(IDAM_PLUGIN_INTERFACE* interface,
-//         const std::unordered_map<std::string,std::unique_ptr<Mapping>>&
-//         entries, const nlohmann::json& global_data) const;
+template int ExprEntry::eval_expr<double>(
+    IDAM_PLUGIN_INTERFACE* interface,
+    const IDSMapRegister& entries,
+    const nlohmann::json& global_data, const RequestContext& request) const;
 
 /**
  * @brief Entry map function, overriden from parent Mapping class
  *
- * @note expression is only of float type for testing purposes
+ * @note expression is evaluated in double, returned as m_output_type
  * @param interface IDAM_PLUGIN_INTERFACE for access to request and data_block
  * @param entries unordered map of all mappings loaded for this experiment and
  * IDS
  * @param global_data global JSON object used in templating
+ * @param request immutable request context
  * @return int error_code
  */
-int ExprEntry::map(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& global_data) const {
+int ExprEntry::map(IDAM_PLUGIN_INTERFACE* interface,
+                   const IDSMapRegister& entries,
+                   const nlohmann::json& global_data,
+                   const RequestContext& request) const {
 
-    // Float only currently for testing purposes
-    return eval_expr<float>(interface, entries, global_data);
+    return eval_expr<double>(interface, entries, global_data, request);
 };
+
+/**
+ * @brief Shape of the expression result, derived from the parameter shapes
+ * without evaluating the expression
+ *
+ * @param shape [out] {length of the first parameter} (see compile_expr),
+ * empty without parameters
+ * @return int error_code
+ */
+int ExprEntry::shape(IDAM_PLUGIN_INTERFACE* interface,
+                     const IDSMapRegister& entries,
+                     const nlohmann::json& global_data,
+                     const RequestContext& request,
+                     std::vector<size_t>& shape) const {
+
+    shape.clear();
+    if (m_parameters.empty()) {
+        return 0;
+    }
+    const auto* first_param = entries.find(m_parameters.begin()->second);
+    if (first_param == nullptr) {
+        return 1;
+    }
+    std::vector<size_t> param_shape;
+    if (first_param->shape(interface, entries, global_data,
+                           request.with_sig_type(SignalType::DEFAULT),
+                           param_shape)) {
+        return 1;
+    }
+    shape.push_back(shape_count(param_shape));
+    return 0;
+}
+
+/**
+ * @brief Map every expression parameter into its own scratch data_block
+ *
+ * Parameters are fetched one after another, source plugins and UDA's error
+ * stack are not thread safe so their fetches could not overlap anyway.
+ *
+ * @param interface IDAM_PLUGIN_INTERFACE of the expression request
+ * @param entries unordered map of all mappings loaded for this experiment and
+ * IDS
+ * @param global_data global JSON object used in templating
+ * @param request immutable request context
+ * @param param_blocks [out] one data_block per parameter, in m_parameters
+ * order, to be freed by the caller
+ * @return int error_code, the first parameter error, or 1 if any parameter
+ * returned no data
+ */
+int ExprEntry::fetch_parameters(
+    IDAM_PLUGIN_INTERFACE* interface,
+    const IDSMapRegister& entries,
+    const nlohmann::json& global_data, const RequestContext& request,
+    std::vector<DATA_BLOCK>& param_blocks) const {
+
+    // Parameters are requested as is, signal type not forwarded
+    const auto param_request = request.with_sig_type(SignalType::DEFAULT);
+
+    param_blocks.resize(m_parameters.size());
+    for (auto& block : param_blocks) {
+        initDataBlock(&block);
+    }
+    IDAM_PLUGIN_INTERFACE param_interface{*interface};
+
+    size_t i_param{0};
+    try {
+        for (const auto& [key, json_name] : m_parameters) {
+            auto& block = param_blocks[i_param++];
+            param_interface.data_block = &block;
+            const auto* entry = entries.find(json_name);
+            // Should really set data type also
+            const int err = entry != nullptr
+                                ? entry->map(&param_interface, entries,
+                                             global_data, param_request)
+                                : 1;
+            // No data for expr parameters, cannot evaluate, return 1;
+            if (err != 0 || !block.data) {
+                return err != 0 ? err : 1;
+            }
+        }
+    } catch (...) {
+        for (auto& block : param_blocks) {
+            freeDataBlock(&block);
+        }
+        param_blocks.clear();
+        throw;
+    }
+    return 0;
+}
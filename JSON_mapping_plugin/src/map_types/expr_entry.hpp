@@ -1,26 +1,74 @@
 #pragma once
 
 #include "map_types/base_entry.hpp"
+#include "utils/convert.hpp"
+#include "utils/template_string.hpp"
 #include "utils/uda_plugin_helpers.hpp"
 
 #include <algorithm>
+#include <clientserver/freeDataBlock.h>
 #include <clientserver/initStructs.h>
 #include <clientserver/udaStructs.h>
+#include <deque>
 #include <exprtk/exprtk.hpp>
-#include <inja/inja.hpp>
+#include <memory>
+#include <mutex>
 #include <plugins/pluginStructs.h>
+#include <type_traits>
 #include <unordered_map>
 
+/**
+ * @brief Data type of the expression result, set per mapping by OUTPUT_TYPE
+ */
+enum class ExprOutputType { FLOAT, DOUBLE, INT };
+NLOHMANN_JSON_SERIALIZE_ENUM(ExprOutputType,
+                             {{ExprOutputType::FLOAT, "float"},
+                              {ExprOutputType::DOUBLE, "double"},
+                              {ExprOutputType::INT, "int"}});
+
+/**
+ * @brief Compiled exprtk expression with rebindable parameter storage
+ *
+ * Vector parameters are bound through exprtk::vector_view so the data
+ * pointer can be rebased per request without recompiling, scalar
+ * parameters are bound to storage owned by this object. A vector result is
+ * bound through a view as well, rebased onto the output data_block array
+ * so the expression writes the result in place. The symbol table holds
+ * references into this object, it must not move.
+ */
+template <typename T> struct CompiledExpr {
+    exprtk::symbol_table<T> symbol_table;
+    exprtk::expression<T> expression;
+    std::deque<exprtk::vector_view<T>> vector_views; // stable addresses
+    std::deque<T> scalars;
+    // Per parameter (in m_parameters order) index into vector_views/scalars
+    std::vector<std::pair<bool, size_t>> param_slots;
+    // Scalar result storage, or the initial binding of the result view
+    std::vector<T> result;
+    size_t result_slot{0}; // index into vector_views of a vector result
+    bool vector_expr{false};
+};
+
+/**
+ * @brief Per entry cache of compiled expressions, keyed on the rendered
+ * expression string and parameter shapes
+ */
+template <typename T> struct ExprCache {
+    static constexpr size_t max_size{16};
+    std::unordered_map<std::string, std::unique_ptr<CompiledExpr<T>>> exprs;
+    std::mutex mutex;
+};
+
 /**
  * @class ExprEntry
  * @brief ExprEntry class to the hold the EXPR MAP_TYPE after parsing from the
  * JSON mapping file
  *
- * The class holds an expression std::string 'm_expr' for evaluation and
- * computation when mapping. The string is evaluated by the templating library
- * pantor/inja on object creation. 'm_parameters' holds the std::strings of the
- * variables needed to evaluate the expression, eg. X+Y requires knowledge or
- * data retrieval of X and Y.
+ * The class holds an expression template 'm_expr' for evaluation and
+ * computation when mapping. The string is parsed by the templating library
+ * pantor/inja on object creation and rendered per request. 'm_parameters'
+ * holds the std::strings of the variables needed to evaluate the expression,
+ * eg. X+Y requires knowledge or data retrieval of X and Y.
  *
  * The evaluation and computation of the expression is done using the expression
  * toolkit library exprtk, this is done in the templated function 'eval_expr'.
@@ -28,126 +76,282 @@
  * the current IDS. Retrieval of the data is done as if the mapping was being
  * retrieved regardless of the expression operation.
  *
+ * Expressions are evaluated in double precision, parameters of any other
+ * numeric type are converted in bulk before evaluation. The result is
+ * returned as 'm_output_type' (OUTPUT_TYPE, float by default).
+ *
+ * Compiled expressions are cached per entry, repeated requests with the same
+ * rendered expression and parameter sizes only rebind the parameter data.
+ *
  */
 class ExprEntry : public Mapping {
   public:
     ExprEntry() = delete;
     ExprEntry(std::string expr,
-              std::unordered_map<std::string, std::string> parameters)
-        : m_expr{std::move(expr)}, m_parameters{std::move(parameters)} {};
+              std::unordered_map<std::string, std::string> parameters,
+              ExprOutputType output_type = ExprOutputType::FLOAT)
+        : m_expr{std::move(expr)}, m_parameters{std::move(parameters)},
+          m_output_type{output_type} {};
 
-    int map(IDAM_PLUGIN_INTERFACE* interface,
-            const std::unordered_map<std::string, std::unique_ptr<Mapping>>&
-                entries,
-            const nlohmann::json& global_data) const override;
+    int map(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+            const nlohmann::json& global_data,
+            const RequestContext& request) const override;
+    int shape(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+              const nlohmann::json& global_data, const RequestContext& request,
+              std::vector<size_t>& shape) const override;
 
   private:
-    std::string m_expr;
+    JMP::templating::TemplateString m_expr;
     std::unordered_map<std::string, std::string> m_parameters;
+    ExprOutputType m_output_type;
+    // Heap allocated, keeps ExprEntry movable into the register arena
+    std::unique_ptr<ExprCache<double>> m_double_exprs{
+        std::make_unique<ExprCache<double>>()};
 
+    int fetch_parameters(IDAM_PLUGIN_INTERFACE* interface,
+                         const IDSMapRegister& entries,
+                         const nlohmann::json& global_data,
+                         const RequestContext& request,
+                         std::vector<DATA_BLOCK>& param_blocks) const;
+    template <typename T> ExprCache<T>& expr_cache() const;
+    template <typename T>
+    std::unique_ptr<CompiledExpr<T>>
+    compile_expr(const std::string& expr_string,
+                 const std::vector<std::pair<T*, size_t>>& params) const;
     template <typename T>
     int eval_expr(IDAM_PLUGIN_INTERFACE* interface,
-                  const std::unordered_map<std::string,
-                                           std::unique_ptr<Mapping>>& entries,
-                  const nlohmann::json& global_data) const;
+                  const IDSMapRegister& entries,
+                  const nlohmann::json& global_data,
+                  const RequestContext& request) const;
+    template <typename T, typename Out>
+    int write_result(DATA_BLOCK* data_block, CompiledExpr<T>& compiled) const;
 };
 
+template <> inline ExprCache<double>& ExprEntry::expr_cache<double>() const {
+    return *m_double_exprs;
+}
+
+/**
+ * @brief Compile the expression against freshly bound parameter storage
+ *
+ * @tparam T expression value type
+ * @param expr_string full expression string, eg. RESULT:=X+Y
+ * @param params data pointer and element count per parameter (in
+ * m_parameters order), a count of 0 binds a scalar
+ * @return std::unique_ptr<CompiledExpr<T>> nullptr if compilation fails
+ */
+template <typename T>
+std::unique_ptr<CompiledExpr<T>> ExprEntry::compile_expr(
+    const std::string& expr_string,
+    const std::vector<std::pair<T*, size_t>>& params) const {
+
+    auto compiled = std::make_unique<CompiledExpr<T>>();
+    compiled->symbol_table.add_constants();
+
+    size_t result_size{1};
+    bool first_vec_param{true};
+    auto param_it = params.begin();
+    for (const auto& [key, json_name] : m_parameters) {
+        const auto& [data, data_n] = *param_it++;
+        if (data_n > 0) {
+            auto& view = compiled->vector_views.emplace_back(
+                exprtk::make_vector_view(data, data_n));
+            compiled->symbol_table.add_vector(key, view);
+            compiled->param_slots.emplace_back(
+                true, compiled->vector_views.size() - 1);
+            if (first_vec_param) {
+                result_size = data_n;
+                first_vec_param = false;
+            }
+            compiled->vector_expr = true;
+        } else {
+            auto& scalar = compiled->scalars.emplace_back(*data);
+            compiled->symbol_table.add_variable(key, scalar);
+            compiled->param_slots.emplace_back(false,
+                                               compiled->scalars.size() - 1);
+        }
+    }
+
+    compiled->result.resize(result_size);
+    if (compiled->vector_expr) {
+        auto& view = compiled->vector_views.emplace_back(
+            exprtk::make_vector_view(compiled->result.data(), result_size));
+        compiled->symbol_table.add_vector("RESULT", view);
+        compiled->result_slot = compiled->vector_views.size() - 1;
+    } else {
+        compiled->symbol_table.add_variable("RESULT",
+                                            compiled->result.front());
+    }
+    compiled->expression.register_symbol_table(compiled->symbol_table);
+
+    exprtk::parser<T> parser;
+    if (!parser.compile(expr_string, compiled->expression)) {
+        UDA_LOG(UDA_LOG_DEBUG, "\nExprEntry::compile_expr - %s\n",
+                parser.error().c_str());
+        return nullptr;
+    }
+    return compiled;
+}
+
 /**
  * @brief Function to
  * (1) perform the evaulation and computation of the expression string
  * using the exprtk library
  * (2) output the data in the correct format to the data_block
  *
- * @tparam T expression parameters template type, in theory the expression can
- * be evaluated with any floating-point type. However this is currently
- * hard-coded to use float.
+ * Parameters are fetched into scratch data_blocks (see fetch_parameters).
+ * Parameters of type T are bound in place, others converted in bulk into
+ * scratch arrays of T. The compiled expression is looked up in the entry
+ * cache, only compiled on a miss, and parameter data rebound before
+ * evaluation.
+ *
+ * @tparam T expression value type, the precision of the evaluation
  *
  * @param out_interface IDAM_PLUGIN_INTERFACE for access to request and
  * data_block
  * @param entries unordered map of all mappings loaded for this experiment and
  * IDS
  * @param global_data global JSON object used in templating
+ * @param request immutable request context
  * @return int error_code
  */
 template <typename T>
 int ExprEntry::eval_expr(
     IDAM_PLUGIN_INTERFACE* out_interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& global_data) const {
-
-    exprtk::symbol_table<T> symbol_table;
-    exprtk::expression<T> expression;
-    exprtk::parser<T> parser;
+    const IDSMapRegister& entries,
+    const nlohmann::json& global_data, const RequestContext& request) const {
 
-    // Copy original request name-value list to map (simplicity)
-    std::unordered_map<std::string, std::string> orig_nvlist_map;
-    const auto* orig_nvlist = &out_interface->request_data->nameValueList;
-    for (int i = 0; i < orig_nvlist->pairCount; i++) {
-        orig_nvlist_map.insert(
-            {orig_nvlist->nameValue[i].name, orig_nvlist->nameValue[i].value});
+    // One scratch data_block per parameter, mapped in turn
+    std::vector<DATA_BLOCK> param_blocks;
+    auto free_params = [&param_blocks]() {
+        // Free parameter memory from subsequent data_block requests
+        for (auto& block : param_blocks) {
+            freeDataBlock(&block);
+        }
+    };
+    if (fetch_parameters(out_interface, entries, global_data, request,
+                         param_blocks)) {
+        free_params();
+        return 1;
     }
 
-    std::vector<char*> parameters_ptrs(m_parameters.size());
-    bool vector_expr{false};
-    bool first_vec_param{true};
-    size_t result_size{1};
-
-    symbol_table.add_constants();
-    for (const auto& [key, json_name] : m_parameters) {
+    // Data pointer and size per parameter, in m_parameters order
+    constexpr int value_type{imas_json_plugin::uda_helpers::uda_type_v<T>};
+    std::vector<std::pair<T*, size_t>> params;
+    std::vector<std::unique_ptr<T[]>> converted;
+    params.reserve(param_blocks.size());
+    for (const auto& block : param_blocks) {
+        const auto count = static_cast<size_t>(std::max(block.data_n, 0));
+        if (block.data_type == value_type) {
+            params.emplace_back(reinterpret_cast<T*>(block.data), count);
+            continue;
+        }
+        auto& values =
+            converted.emplace_back(new T[std::max<size_t>(count, 1)]);
+        if (JMP::map_transform::convert_data(
+                block.data, block.data_type,
+                reinterpret_cast<char*>(values.get()), value_type, count)) {
+            UDA_LOG(UDA_LOG_DEBUG,
+                    "\nExprEntry::eval_expr - unsupported parameter type\n");
+            free_params();
+            return 1;
+        }
+        params.emplace_back(values.get(), count);
+    }
 
-        initDataBlock(out_interface->data_block); // Reset datablock per param
-        entries.at(json_name)->set_current_request_data_map(orig_nvlist_map);
-        // Should really set data type also
-        entries.at(json_name)->map(out_interface, entries, global_data);
+    // replace patterns in expression if necessary, eg expression: RESULT:=X+Y
+    const std::string expr_string{"RESULT:=" + m_expr.render(global_data)};
+    // Vector views are fixed size, parameter sizes are part of the key
+    std::string cache_key{expr_string};
+    for (const auto& [ptr, size] : params) {
+        cache_key += ';' + std::to_string(size);
+    }
 
-        // No data for expr parameters, cannot evaluate, return 1;
-        if (!out_interface->data_block->data) {
+    auto& cache = expr_cache<T>();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto cache_it = cache.exprs.find(cache_key);
+    if (cache_it == cache.exprs.end()) {
+        auto compiled = compile_expr<T>(expr_string, params);
+        if (!compiled) {
+            free_params();
             return 1;
         }
+        if (cache.exprs.size() >= ExprCache<T>::max_size) {
+            cache.exprs.clear();
+        }
+        cache_it = cache.exprs.emplace(cache_key, std::move(compiled)).first;
+    }
+    auto& compiled = *cache_it->second;
 
-        if (out_interface->data_block->data_n > 0) {
-            symbol_table.add_vector(
-                key, reinterpret_cast<T*>(out_interface->data_block->data),
-                out_interface->data_block->data_n);
-            if (first_vec_param) {
-                result_size = out_interface->data_block->data_n;
-                first_vec_param = false;
-            }
-            vector_expr = true;
+    // Rebind parameter data, no recompilation needed
+    for (size_t i = 0; i < params.size(); ++i) {
+        const auto& [is_vector, slot] = compiled.param_slots[i];
+        if (is_vector) {
+            compiled.vector_views[slot].rebase(params[i].first);
         } else {
-            symbol_table.add_variable(
-                key, *reinterpret_cast<T*>(out_interface->data_block->data));
+            compiled.scalars[slot] = *params[i].first;
         }
-        // Collect vectors for deletion later
-        parameters_ptrs.push_back(out_interface->data_block->data);
     }
 
-    std::vector<T> result(result_size);
-    if (vector_expr) {
-        symbol_table.add_vector("RESULT", result);
-    } else {
-        symbol_table.add_variable("RESULT", result.front());
+    int err{1};
+    switch (m_output_type) {
+    case ExprOutputType::DOUBLE:
+        err = write_result<T, double>(out_interface->data_block, compiled);
+        break;
+    case ExprOutputType::INT:
+        err = write_result<T, int>(out_interface->data_block, compiled);
+        break;
+    default:
+        err = write_result<T, float>(out_interface->data_block, compiled);
+        break;
     }
-    expression.register_symbol_table(symbol_table);
 
-    // replace patterns in expression if necessary, eg expression: RESULT:=X+Y
-    std::string expr_string{"RESULT:=" + inja::render(m_expr, global_data)};
-    parser.compile(expr_string, expression);
-    expression.value(); // Evaluate expression
+    free_params();
+    return err;
+};
 
-    if (vector_expr) {
-        imas_json_plugin::uda_helpers::setReturnDataArrayType_Vec(
-            out_interface->data_block, result);
-    } else {
-        imas_json_plugin::uda_helpers::setReturnDataScalarType(
-            out_interface->data_block, result.at(0));
+/**
+ * @brief Evaluate the bound expression and return the result as Out
+ *
+ * A vector result of the evaluation type is written straight into the
+ * data_block array, otherwise it is evaluated into the scratch result and
+ * converted in bulk.
+ *
+ * @tparam T expression value type
+ * @tparam Out output data type
+ * @param data_block output data_block
+ * @param compiled expression with its parameters bound
+ * @return int error_code
+ */
+template <typename T, typename Out>
+int ExprEntry::write_result(DATA_BLOCK* data_block,
+                            CompiledExpr<T>& compiled) const {
+
+    if (!compiled.vector_expr) {
+        compiled.expression.value(); // Evaluate expression
+        return imas_json_plugin::uda_helpers::setReturnDataScalarType<Out>(
+            data_block, static_cast<Out>(compiled.result.at(0)));
     }
 
-    // Free parameter memory from subsequent data_block requests
-    for (auto& ptr : parameters_ptrs) {
-        free(ptr);
-        ptr = nullptr;
+    const size_t count{compiled.result.size()};
+    Out* data = imas_json_plugin::uda_helpers::allocReturnDataArray<Out>(
+        data_block, count);
+    if (data == nullptr) {
+        return 1;
+    }
+    auto& result_view = compiled.vector_views[compiled.result_slot];
+    if constexpr (std::is_same_v<T, Out>) {
+        result_view.rebase(data);
+        compiled.expression.value(); // Evaluate expression
+        return 0;
+    } else {
+        result_view.rebase(compiled.result.data());
+        compiled.expression.value(); // Evaluate expression
+        return JMP::map_transform::convert_data(
+            reinterpret_cast<const char*>(compiled.result.data()),
+            imas_json_plugin::uda_helpers::uda_type_v<T>,
+            reinterpret_cast<char*>(data),
+            imas_json_plugin::uda_helpers::uda_type_v<Out>, count);
     }
+}
 
-    return 0;
-};
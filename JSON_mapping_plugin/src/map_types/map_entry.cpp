@@ -4,11 +4,52 @@
  */
 
 #include "map_entry.hpp"
+#include "handlers/result_cache.hpp"
 
 #include "utils/scale_offset.hpp"
 #include "utils/uda_plugin_helpers.hpp"
 #include <boost/format.hpp>
-#include <inja/inja.hpp>
+#include <clientserver/freeDataBlock.h>
+#include <mutex>
+
+namespace {
+
+/**
+ * @brief Call the source plugin for a request string, one source call at a
+ * time
+ *
+ * Source plugins (UDA client, GEOM) and UDA's error stack are not thread
+ * safe, background prefetches only overlap their templating and cache
+ * stores with the foreground request.
+ */
+int call_source(IDAM_PLUGIN_INTERFACE* interface,
+                const std::string& request_str) {
+    static std::recursive_mutex source_mutex;
+    std::lock_guard<std::recursive_mutex> lock(source_mutex);
+    return callPlugin(interface->pluginList, request_str.c_str(), interface);
+}
+
+} // namespace
+
+/**
+ * @brief Parse the string request arguments into inja templates once, at
+ * mapping load time
+ *
+ * Boolean arguments are kept as flags, other non-string types are dropped
+ * as they are never part of the request string
+ */
+void MapEntry::compile_request_args() {
+
+    m_request_args.reserve(m_map_args.size());
+    for (const auto& [key, field] : m_map_args) {
+        if (field.is_string()) {
+            m_request_args.emplace_back(key, JMP::templating::TemplateString(
+                                                 field.get<std::string>()));
+        } else if (field.is_boolean()) {
+            m_request_args.emplace_back(key, std::nullopt);
+        }
+    }
+}
 
 /**
  * @brief
@@ -19,35 +60,34 @@
  * eg. JSONDataReader::get(signal=/APC/plasma_current);
  *
  * @param json_globals
+ * @param request
+ * @param function plugin function to call, get by default
  * @return
  */
 std::string
-MapEntry::get_request_str(const nlohmann::json& json_globals) const {
+MapEntry::get_request_str(const nlohmann::json& json_globals,
+                          const RequestContext& request,
+                          std::string_view function) const {
 
     // TODO: replace dependence on boost in the future
     // stringstream?
-    std::string request_str = m_plugin.second + "::get(";
+    std::string request_str = m_plugin.second + "::";
+    request_str += function;
+    request_str += '(';
 
-    // m_map_args 'field' currently nlohmann json
-    // parse to string/bool
-    // TODO: change, however std::any/std::variant functionality for free
-    for (const auto& [key, field] : m_map_args) {
-        if (field.is_string()) {
+    // Templates pre-parsed in compile_request_args, only rendered here
+    for (const auto& [key, field] : m_request_args) {
+        if (field.has_value()) {
             request_str +=
-                (boost::format("%s=%s, ") % key %
-                 inja::render( // Double inja
-                     inja::render(field.get<std::string>(), json_globals),
-                     json_globals))
+                (boost::format("%s=%s, ") % key % field->render(json_globals))
                     .str();
-        } else if (field.is_boolean()) {
-            request_str += (boost::format("%s, ") % key).str();
         } else {
-            continue;
+            request_str += (boost::format("%s, ") % key).str();
         }
     }
     request_str +=
-        (boost::format("source=%i, host=%s, port=%i)") % m_request_data.shot %
-         m_request_data.host % m_request_data.port)
+        (boost::format("source=%i, host=%s, port=%i)") % request.shot %
+         request.host % request.port)
             .str();
 
     // Add slice to request (when implemented)
@@ -60,20 +100,35 @@ MapEntry::get_request_str(const nlohmann::json& json_globals) const {
 }
 
 int MapEntry::call_plugins(IDAM_PLUGIN_INTERFACE* interface,
-                           const nlohmann::json& json_globals) const {
+                           const nlohmann::json& json_globals,
+                           const RequestContext& request) const {
 
     int err{1};
-    auto request_str = get_request_str(json_globals);
+    auto request_str = get_request_str(json_globals, request);
     if (request_str.empty()) {
         return err;
     } // Return 1 if no request receieved
 
-    err = callPlugin(interface->pluginList, request_str.c_str(), interface);
-    if (err) {
-        return err;
-    } // return code if failure, no need to proceed
+    // Each distinct request string is fetched once per request, eg. every
+    // channel sliced from one 2D signal, or data and time of one signal.
+    // Signals prefetched ahead of the request are not fetched at all
+    JMP::cache::ResultCache* memo = request.memo;
+    JMP::cache::ResultCache* prefetched = request.prefetched;
+    err = 0;
+    if ((memo == nullptr || !memo->enabled() ||
+         !memo->restore(request_str, interface->data_block)) &&
+        (prefetched == nullptr || !prefetched->enabled() ||
+         !prefetched->restore(request_str, interface->data_block))) {
+        err = call_source(interface, request_str);
+        if (err) {
+            return err;
+        } // return code if failure, no need to proceed
+        if (memo != nullptr) {
+            memo->store(request_str, interface->data_block);
+        }
+    }
 
-    if (m_request_data.sig_type == SignalType::TIME) {
+    if (request.sig_type == SignalType::TIME) {
         // Opportunity to handle time differently
         // Return time SignalType early, no need to scale/offset
         if (m_plugin.first == PluginType::UDA) {
@@ -83,22 +138,96 @@ int MapEntry::call_plugins(IDAM_PLUGIN_INTERFACE* interface,
         return err;
     }
 
-    if (m_scale.has_value()) {
-        err = JMP::map_transform::transform_scale(interface->data_block,
-                                                  m_scale.value());
-    }
-    if (m_offset.has_value()) {
-        err = JMP::map_transform::transform_offset(interface->data_block,
-                                                   m_offset.value());
+    if (m_scale.has_value() || m_offset.has_value() || m_promote_double) {
+        // Single fused pass, y = x * scale + offset
+        err = JMP::map_transform::transform_scale_offset(
+            interface->data_block, m_scale.value_or(1.0F),
+            m_offset.value_or(0.0F), m_promote_double);
     }
 
     return err;
 }
 
-int MapEntry::map(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& json_globals) const {
+int MapEntry::map(IDAM_PLUGIN_INTERFACE* interface,
+                  const IDSMapRegister& entries,
+                  const nlohmann::json& json_globals,
+                  const RequestContext& request) const {
 
-    return call_plugins(interface, json_globals);
+    return call_plugins(interface, json_globals, request);
 };
+
+/**
+ * @brief Fetch the source signal into cache ahead of the request mapping
+ * it, nothing is fetched if it is already cached
+ *
+ * Only the raw source result is cached, scale, offset and time handling are
+ * still applied by map when the cached result is used.
+ *
+ * @param interface plugin interface used for the source request, its
+ * data_block is left untouched
+ * @param cache raw results keyed by request string
+ * @return int error_code
+ */
+int MapEntry::prefetch(IDAM_PLUGIN_INTERFACE* interface,
+                       const nlohmann::json& json_globals,
+                       const RequestContext& request,
+                       JMP::cache::ResultCache& cache) const {
+
+    const auto request_str = get_request_str(json_globals, request);
+    if (cache.contains(request_str)) {
+        return 0;
+    }
+    DATA_BLOCK fetch_block;
+    initDataBlock(&fetch_block);
+    IDAM_PLUGIN_INTERFACE fetch_interface{*interface};
+    fetch_interface.data_block = &fetch_block;
+
+    const int err = call_source(&fetch_interface, request_str);
+    if (!err) {
+        cache.store(request_str, &fetch_block);
+    }
+    freeDataBlock(&fetch_block);
+    return err;
+}
+
+/**
+ * @brief Shape of the mapped signal without transferring its data
+ *
+ * The DRaFT JSON reader answers a shape request directly, an unknown
+ * signal is an error. Other source plugins cannot return dimensions only,
+ * the signal is fetched (or reused from the request memo) and its
+ * dimensions kept.
+ *
+ * @param shape [out] dimension lengths in UDA dims order, empty for scalars
+ * @return int error_code
+ */
+int MapEntry::shape(IDAM_PLUGIN_INTERFACE* interface,
+                    const IDSMapRegister& entries,
+                    const nlohmann::json& json_globals,
+                    const RequestContext& request,
+                    std::vector<size_t>& shape) const {
+
+    if (m_plugin.first != PluginType::JSONReader) {
+        return Mapping::shape(interface, entries, json_globals, request,
+                              shape);
+    }
+
+    const auto request_str = get_request_str(json_globals, request, "shape");
+    DATA_BLOCK shape_block;
+    initDataBlock(&shape_block);
+    IDAM_PLUGIN_INTERFACE shape_interface{*interface};
+    shape_interface.data_block = &shape_block;
+
+    int err = call_source(&shape_interface, request_str);
+    shape.clear();
+    if (!err && shape_block.data_type == UDA_TYPE_INT) {
+        const auto* dims = reinterpret_cast<const int*>(shape_block.data);
+        shape.assign(dims, dims + shape_block.data_n);
+    } else if (!err) {
+        err = 1;
+    }
+    freeDataBlock(&shape_block);
+    // A failed shape request (eg. unknown signal) is not retried as a fetch,
+    // the reader would return a missing signal as empty data
+    return err;
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "base_entry.hpp"
+#include "utils/template_string.hpp"
 #include <optional>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 enum class PluginType { UDA, GEOMETRY, JSONReader };
 
@@ -16,23 +19,42 @@ class MapEntry : public Mapping {
   public:
     MapEntry() = delete;
     MapEntry(std::pair<PluginType, std::string> plugin, MapArgs_t request_args,
-             std::optional<float> offset, std::optional<float> scale)
+             std::optional<float> offset, std::optional<float> scale,
+             bool promote_double = false)
         : m_plugin{std::move(plugin)}, m_map_args{std::move(request_args)},
-          m_offset{offset}, m_scale{scale} {};
+          m_offset{offset}, m_scale{scale}, m_promote_double{promote_double} {
+        compile_request_args();
+    };
 
-    int map(IDAM_PLUGIN_INTERFACE* interface,
-            const std::unordered_map<std::string, std::unique_ptr<Mapping>>&
-                entries,
-            const nlohmann::json& json_globals) const override;
+    int map(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+            const nlohmann::json& json_globals,
+            const RequestContext& request) const override;
+    int shape(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+              const nlohmann::json& json_globals, const RequestContext& request,
+              std::vector<size_t>& shape) const override;
+    int prefetch(IDAM_PLUGIN_INTERFACE* interface,
+                 const nlohmann::json& json_globals,
+                 const RequestContext& request,
+                 JMP::cache::ResultCache& cache) const;
 
   private:
     std::pair<PluginType, std::string> m_plugin;
     MapArgs_t m_map_args;
     std::optional<float> m_offset;
     std::optional<float> m_scale;
+    // Return scaled/offset data as double instead of the source type
+    bool m_promote_double;
+    // Request arguments with string values pre-parsed, std::nullopt for flags
+    std::vector<std::pair<std::string,
+                          std::optional<JMP::templating::TemplateString>>>
+        m_request_args;
 
+    void compile_request_args();
     [[nodiscard]] std::string
-    get_request_str(const nlohmann::json& json_globals) const;
+    get_request_str(const nlohmann::json& json_globals,
+                    const RequestContext& request,
+                    std::string_view function = "get") const;
     int call_plugins(IDAM_PLUGIN_INTERFACE* interface,
-                     const nlohmann::json& json_globals) const;
+                     const nlohmann::json& json_globals,
+                     const RequestContext& request) const;
 };
@@ -1,49 +1,75 @@
 #include "map_types/slice_entry.hpp"
-#include "utils/uda_plugin_helpers.hpp"
-#include <algorithm>
-#include <inja/inja.hpp>
+#include "handlers/map_register.hpp"
 #include <plugins/udaPlugin.h>
 
-int SliceEntry::map(
-    IDAM_PLUGIN_INTERFACE* interface,
-    const std::unordered_map<std::string, std::unique_ptr<Mapping>>& entries,
-    const nlohmann::json& json_globals) const {
+using JMP::map_transform::SliceSpec;
 
+int SliceEntry::map(IDAM_PLUGIN_INTERFACE* interface,
+                    const IDSMapRegister& entries,
+                    const nlohmann::json& json_globals,
+                    const RequestContext& request) const {
+
+    const auto* source = entries.find(m_slice_key);
+    std::vector<SliceSpec> specs;
+    if (source == nullptr || render_specs(json_globals, specs)) {
+        return 1;
+    }
+
+    // Sliced signal is requested as is, signal type not forwarded
+    const auto source_request = request.with_sig_type(SignalType::DEFAULT);
+
+    // The whole signal is fetched and sliced in place
     int err{1};
-    if (!entries.at(m_slice_key)
-             ->set_current_request_data(
-                 &interface->request_data->nameValueList) &&
-        !entries.at(m_slice_key)->map(interface, entries, json_globals)) {
-        err = map_slice(interface->data_block, json_globals);
+    if (!source->map(interface, entries, json_globals, source_request)) {
+        err = JMP::map_transform::slice_data_block(interface->data_block,
+                                                   specs);
     }
     return err;
 };
 
-int SliceEntry::map_slice(DataBlock* data_block,
-                          const nlohmann::json& json_globals) const {
-
-    int len_array{data_block->data_n / data_block->dims->dim_n};
-    int err{1};
+/**
+ * @brief Shape of the slice, derived from the shape of the sliced signal
+ *
+ * @param shape [out] shape of the sliced signal without the indexed
+ * dimensions
+ * @return int error_code
+ */
+int SliceEntry::shape(IDAM_PLUGIN_INTERFACE* interface,
+                      const IDSMapRegister& entries,
+                      const nlohmann::json& json_globals,
+                      const RequestContext& request,
+                      std::vector<size_t>& shape) const {
 
-    // convert str_indices to int and complete template
-    std::vector<int> int_indices;
-    std::transform(m_slice_indices.begin(), m_slice_indices.end(),
-                   std::back_inserter(int_indices), [&](std::string str) {
-                       str = inja::render(str, json_globals);
-                       return stoi(str);
-                   });
-    if (data_block->rank == 2) {
-        // test case with float
-        const auto temp = get_slice2D<float>(
-            {reinterpret_cast<float*>(data_block->data),
-             static_cast<size_t>(data_block->data_n)},
-            int_indices.at(0), {len_array, data_block->dims->dim_n});
-
-        free((void*)data_block->data);
-        data_block->data = nullptr;
-        err = imas_json_plugin::uda_helpers::setReturnDataValArray(data_block,
-                                                                   temp);
+    const auto* source = entries.find(m_slice_key);
+    std::vector<SliceSpec> specs;
+    if (source == nullptr || render_specs(json_globals, specs)) {
+        return 1;
     }
+    std::vector<size_t> source_shape;
+    if (source->shape(interface, entries, json_globals,
+                      request.with_sig_type(SignalType::DEFAULT),
+                      source_shape)) {
+        return 1;
+    }
+    return JMP::map_transform::slice_shape(specs, source_shape, shape);
+}
 
-    return err;
+/**
+ * @brief Render and parse the templated slice indices, eg. {{indices.0}},
+ * ":" or "0:{{n}}:2"
+ *
+ * @param specs [out] one selection per leading dimension
+ * @return int error_code, 1 for a malformed index
+ */
+int SliceEntry::render_specs(const nlohmann::json& json_globals,
+                             std::vector<SliceSpec>& specs) const {
+
+    specs.resize(m_slice_indices.size());
+    for (size_t i = 0; i < m_slice_indices.size(); ++i) {
+        if (JMP::map_transform::parse_slice_spec(
+                m_slice_indices[i].render(json_globals), specs[i])) {
+            return 1;
+        }
+    }
+    return 0;
 }
@@ -1,33 +1,31 @@
+#pragma once
+
 #include "map_types/base_entry.hpp"
+#include "utils/slicing.hpp"
+#include "utils/template_string.hpp"
 
 class SliceEntry : public Mapping {
   public:
     SliceEntry() = delete;
     SliceEntry(std::vector<std::string> slice_indices, std::string slice_key)
-        : m_slice_indices(std::move(slice_indices)),
-          m_slice_key(std::move(slice_key)) {}
+        : m_slice_key(std::move(slice_key)) {
+        m_slice_indices.reserve(slice_indices.size());
+        for (auto& index : slice_indices) {
+            m_slice_indices.emplace_back(std::move(index));
+        }
+    }
 
-    int map(IDAM_PLUGIN_INTERFACE* interface,
-            const std::unordered_map<std::string, std::unique_ptr<Mapping>>&
-                entries,
-            const nlohmann::json& json_globals) const override;
+    int map(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+            const nlohmann::json& json_globals,
+            const RequestContext& request) const override;
+    int shape(IDAM_PLUGIN_INTERFACE* interface, const IDSMapRegister& entries,
+              const nlohmann::json& json_globals, const RequestContext& request,
+              std::vector<size_t>& shape) const override;
 
   private:
-    std::vector<std::string> m_slice_indices;
+    std::vector<JMP::templating::TemplateString> m_slice_indices;
     std::string m_slice_key;
 
-    int map_slice(DataBlock* data_block, const nlohmann::json& json_globals)
-        const; // const for some reason
-    template <typename T>
-    std::valarray<T> get_slice2D(std::valarray<T>&& orig, int slice_index,
-                                 std::pair<int, int> shape) const;
+    int render_specs(const nlohmann::json& json_globals,
+                     std::vector<JMP::map_transform::SliceSpec>& specs) const;
 };
-
-template <typename T>
-std::valarray<T> SliceEntry::get_slice2D(std::valarray<T>&& orig,
-                                         int slice_index,
-                                         std::pair<int, int> shape) const {
-
-    // Replace with templated strings like {{indices.0}}
-    return orig[std::slice(slice_index, shape.first, shape.second)];
-}
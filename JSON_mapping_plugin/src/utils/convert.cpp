@@ -0,0 +1,161 @@
+#include "utils/convert.hpp"
+#include "utils/scale_offset.hpp"
+#include "utils/uda_type_traits.hpp"
+
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+#define JMP_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+namespace JMP::map_transform {
+
+namespace {
+
+template <typename In, typename Out>
+void convert_scalar(const In* in, Out* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<Out>(in[i]);
+    }
+}
+
+#ifdef JMP_CONVERT_X86
+
+/*
+ * Explicit kernels, compiled for their instruction set via target attributes
+ * and only called once simd_level() has confirmed CPU support. Tails are
+ * handled by the portable loop.
+ */
+
+__attribute__((target("avx2"))) void convert_avx2(const float* in,
+                                                  double* out, size_t count) {
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm_loadu_ps(in + i)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx2"))) void convert_avx2(const int* in, double* out,
+                                                  size_t count) {
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        const auto* ptr = reinterpret_cast<const __m128i*>(in + i);
+        _mm256_storeu_pd(out + i, _mm256_cvtepi32_pd(_mm_loadu_si128(ptr)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx2"))) void convert_avx2(const double* in,
+                                                  float* out, size_t count) {
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+// Truncation towards zero, as static_cast
+__attribute__((target("avx2"))) void convert_avx2(const double* in, int* out,
+                                                  size_t count) {
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        auto* ptr = reinterpret_cast<__m128i*>(out + i);
+        _mm_storeu_si128(ptr, _mm256_cvttpd_epi32(_mm256_loadu_pd(in + i)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void
+convert_avx512(const float* in, double* out, size_t count) {
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_cvtps_pd(_mm256_loadu_ps(in + i)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void
+convert_avx512(const int* in, double* out, size_t count) {
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        const auto* ptr = reinterpret_cast<const __m256i*>(in + i);
+        _mm512_storeu_pd(out + i, _mm512_maskz_cvtepi32_pd(
+                                      0xFF, _mm256_loadu_si256(ptr)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void
+convert_avx512(const double* in, float* out, size_t count) {
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _mm512_cvtpd_ps(_mm512_loadu_pd(in + i)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+__attribute__((target("avx512f"))) void
+convert_avx512(const double* in, int* out, size_t count) {
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m256i*>(out + i);
+        _mm256_storeu_si256(
+            ptr, _mm512_maskz_cvttpd_epi32(0xFF, _mm512_loadu_pd(in + i)));
+    }
+    convert_scalar(in + i, out + i, count - i);
+}
+
+#endif // JMP_CONVERT_X86
+
+template <typename In, typename Out>
+inline constexpr bool has_simd_kernel_v =
+    (std::is_same_v<Out, double> &&
+     (std::is_same_v<In, float> || std::is_same_v<In, int>)) ||
+    (std::is_same_v<In, double> &&
+     (std::is_same_v<Out, float> || std::is_same_v<Out, int>));
+
+template <typename In, typename Out>
+void convert_array(const In* in, Out* out, size_t count) {
+#ifdef JMP_CONVERT_X86
+    if constexpr (has_simd_kernel_v<In, Out>) {
+        switch (simd_level()) {
+        case SimdLevel::AVX512:
+            convert_avx512(in, out, count);
+            return;
+        case SimdLevel::AVX2:
+            convert_avx2(in, out, count);
+            return;
+        default:
+            break;
+        }
+    }
+#endif
+    convert_scalar(in, out, count);
+}
+
+} // namespace
+
+int convert_data(const char* in, int in_type, char* out, int out_type,
+                 size_t count) {
+
+    using imas_json_plugin::uda_helpers::visit_uda_type;
+    return visit_uda_type(in_type, [&](auto in_tag) {
+        using In = typename decltype(in_tag)::type;
+        return visit_uda_type(out_type, [&](auto out_tag) {
+            using Out = typename decltype(out_tag)::type;
+            if constexpr (std::is_arithmetic_v<In> &&
+                          std::is_arithmetic_v<Out>) {
+                convert_array(reinterpret_cast<const In*>(in),
+                              reinterpret_cast<Out*>(out), count);
+                return 0;
+            } else {
+                return 1;
+            }
+        });
+    });
+}
+
+} // namespace JMP::map_transform
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+namespace JMP::map_transform {
+
+/**
+ * @brief Bulk conversion between atomic UDA types, out[i] = (Out)in[i]
+ *
+ * Dispatched once per array on both types. Float and int to double and
+ * double to float and int, the conversions on the expression path, use
+ * explicit AVX2/AVX-512 kernels when the CPU supports them (see
+ * simd_level), other pairs a plain loop.
+ *
+ * @param in input array
+ * @param in_type UDA_TYPE of in
+ * @param out output array, must not alias in
+ * @param out_type UDA_TYPE of out
+ * @param count number of elements
+ * @return int error_code, 1 if either type is not a real numeric type
+ */
+int convert_data(const char* in, int in_type, char* out, int out_type,
+                 size_t count);
+
+} // namespace JMP::map_transform
@@ -0,0 +1,151 @@
+#include "utils/file_watcher.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace JMP::watch {
+
+namespace {
+
+// Stop flag poll interval while idle
+constexpr std::chrono::milliseconds idle_poll{250};
+
+void add_path(std::vector<std::string>& paths, std::string path) {
+    if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+        paths.push_back(std::move(path));
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Add a directory to the watch, may be called before start or from
+ * the callback
+ *
+ * @param directory existing directory
+ * @return int error_code
+ */
+int FileWatcher::watch(const std::string& directory) {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd < 0) {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0) {
+            return 1;
+        }
+    }
+    const int wd = inotify_add_watch(m_fd, directory.c_str(),
+                                     IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+        return 1;
+    }
+    m_directories[wd] = directory;
+    return 0;
+}
+
+/**
+ * @brief Start the watcher thread
+ *
+ * @param callback called on the watcher thread with the changed paths
+ * @param settle quiet time after the last event before reporting
+ * @return int error_code, 1 if nothing is watched or already running
+ */
+int FileWatcher::start(Callback_t callback, std::chrono::milliseconds settle) {
+
+    if (m_fd < 0 || running()) {
+        return 1;
+    }
+    m_callback = std::move(callback);
+    m_settle = settle;
+    m_stop = false;
+    m_thread = std::thread(&FileWatcher::run, this);
+    return 0;
+}
+
+/**
+ * @brief Stop the watcher thread and remove every watch, a callback in
+ * progress completes first
+ */
+void FileWatcher::stop() {
+
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_directories.clear();
+}
+
+void FileWatcher::read_events(std::vector<std::string>& changed_paths) {
+
+    alignas(inotify_event) char buffer[4096];
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (true) {
+        const ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN, queue drained
+            return;
+        }
+        for (ssize_t pos = 0; pos < length;) {
+            const auto* event =
+                reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const auto& [wd, directory] : m_directories) {
+                    add_path(changed_paths, directory);
+                }
+                continue;
+            }
+            const auto directory = m_directories.find(event->wd);
+            if (directory == m_directories.end() || event->len == 0) {
+                continue;
+            }
+            add_path(changed_paths,
+                     (std::filesystem::path{directory->second} / event->name)
+                         .string());
+        }
+    }
+}
+
+void FileWatcher::run() {
+
+    using Clock_t = std::chrono::steady_clock;
+    std::vector<std::string> changed_paths;
+    Clock_t::time_point deadline;
+
+    while (!m_stop) {
+        auto timeout = idle_poll;
+        if (!changed_paths.empty()) {
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - Clock_t::now());
+            timeout = std::min(idle_poll, remaining);
+            timeout = std::max(timeout, std::chrono::milliseconds{0});
+        }
+        pollfd poll_fd{m_fd, POLLIN, 0};
+        const int ready = poll(&poll_fd, 1, static_cast<int>(timeout.count()));
+        if (ready < 0 && errno != EINTR) {
+            return;
+        }
+        if (ready > 0) {
+            read_events(changed_paths);
+            deadline = Clock_t::now() + m_settle;
+            continue;
+        }
+        if (!changed_paths.empty() && Clock_t::now() >= deadline) {
+            m_callback(changed_paths);
+            changed_paths.clear();
+        }
+    }
+}
+
+} // namespace JMP::watch
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace JMP::watch {
+
+/**
+ * @class FileWatcher
+ * @brief Background inotify watch of a set of directories
+ *
+ * Files written in place (IN_CLOSE_WRITE) or renamed into a watched
+ * directory (IN_MOVED_TO, as editors and jmp_compile_bundle do) are
+ * collected until no further event arrives for the settle time, then
+ * reported in one callback on the watcher thread. If the kernel event queue
+ * overflows every watched directory is reported instead.
+ */
+class FileWatcher {
+  public:
+    using Callback_t =
+        std::function<void(const std::vector<std::string>& changed_paths)>;
+
+    FileWatcher() = default;
+    ~FileWatcher() { stop(); }
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    int watch(const std::string& directory);
+    int start(Callback_t callback, std::chrono::milliseconds settle);
+    void stop();
+    [[nodiscard]] bool running() const { return m_thread.joinable(); }
+
+  private:
+    void run();
+    void read_events(std::vector<std::string>& changed_paths);
+
+    int m_fd{-1};
+    // Watch descriptor -> directory
+    std::unordered_map<int, std::string> m_directories;
+    std::mutex m_mutex;
+    Callback_t m_callback;
+    std::chrono::milliseconds m_settle{0};
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+};
+
+} // namespace JMP::watch
@@ -0,0 +1,204 @@
+#include "utils/getmany_result.hpp"
+#include "utils/uda_plugin_helpers.hpp"
+
+#include <clientserver/freeDataBlock.h>
+#include <clientserver/udaTypes.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <structures/struct.h>
+
+namespace JMP::getmany {
+
+namespace {
+
+void add_field(USERDEFINEDTYPE& user_type, const char* name, const char* desc,
+               size_t member_offset, unsigned short type_id) {
+    COMPOUNDFIELD field;
+    initCompoundField(&field);
+    int offset{static_cast<int>(member_offset)};
+    defineField(&field, name, desc, &offset, type_id);
+    addCompoundField(&user_type, field);
+}
+
+void init_type(USERDEFINEDTYPE& user_type, const char* name, size_t size) {
+    initUserDefinedType(&user_type);
+    user_type.idamclass = UDA_TYPE_COMPOUND;
+    strcpy(user_type.name, name);
+    strcpy(user_type.source, "JSON_mapping_plugin");
+    user_type.ref_id = 0;
+    user_type.imagecount = 0;
+    user_type.image = nullptr;
+    user_type.size = static_cast<int>(size);
+}
+
+/**
+ * @brief Null terminated heap copy of text, registered in the malloc log
+ */
+char* new_string(std::string_view text, LOGMALLOCLIST* malloc_list) {
+    auto* copy = static_cast<char*>(malloc(text.size() + 1));
+    text.copy(copy, text.size());
+    copy[text.size()] = '\0';
+    addMalloc(malloc_list, copy, 1, text.size() + 1, "char");
+    return copy;
+}
+
+} // namespace
+
+/**
+ * @brief Register the getmany compound types, once per type list
+ *
+ * @param type_list plugin interface user defined type list
+ */
+void define_types(USERDEFINEDTYPELIST* type_list) {
+
+    if (findUserDefinedType(type_list, result_type_name, 0) != nullptr) {
+        return;
+    }
+
+    USERDEFINEDTYPE element_type;
+    init_type(element_type, element_type_name, sizeof(GetManyElement));
+    add_field(element_type, "element", "IDS element path",
+              offsetof(GetManyElement, element), SCALARSTRING);
+    add_field(element_type, "status", "Mapping error code, 0 success",
+              offsetof(GetManyElement, status), SCALARINT);
+    add_field(element_type, "message", "Failure description",
+              offsetof(GetManyElement, message), SCALARSTRING);
+    add_field(element_type, "data_type", "UDA type of data",
+              offsetof(GetManyElement, data_type), SCALARINT);
+    add_field(element_type, "rank", "Number of dimensions",
+              offsetof(GetManyElement, rank), SCALARINT);
+    add_field(element_type, "count", "Number of data elements",
+              offsetof(GetManyElement, count), SCALARINT);
+    add_field(element_type, "shape", "Dimension lengths",
+              offsetof(GetManyElement, shape), ARRAYINT);
+    add_field(element_type, "data", "Raw data bytes, typed by data_type",
+              offsetof(GetManyElement, data), ARRAYUCHAR);
+    addUserDefinedType(type_list, element_type);
+
+    USERDEFINEDTYPE result_type;
+    init_type(result_type, result_type_name, sizeof(GetManyResult));
+    add_field(result_type, "count", "Number of elements",
+              offsetof(GetManyResult, count), SCALARINT);
+
+    // Pointer to the element structure array, its length is resolved from
+    // the malloc log
+    COMPOUNDFIELD field;
+    initCompoundField(&field);
+    strcpy(field.name, "elements");
+    strcpy(field.type, element_type_name);
+    strcpy(field.desc, "Mapped IDS elements");
+    field.atomictype = UDA_TYPE_UNKNOWN;
+    field.pointer = 1;
+    field.count = 1;
+    field.rank = 0;
+    field.shape = nullptr;
+    field.size = static_cast<int>(sizeof(GetManyElement*));
+    field.offset = static_cast<int>(offsetof(GetManyResult, elements));
+    field.offpad = static_cast<int>(padding(field.offset, field.type));
+    field.alignment = static_cast<int>(getalignmentof(field.type));
+    addCompoundField(&result_type, field);
+    addUserDefinedType(type_list, result_type);
+}
+
+/**
+ * @brief Allocate a zeroed element array, registered in the malloc log
+ *
+ * @param count number of elements
+ * @param malloc_list plugin interface malloc log
+ * @return GetManyElement* element array
+ */
+GetManyElement* new_elements(int count, LOGMALLOCLIST* malloc_list) {
+    auto* elements =
+        static_cast<GetManyElement*>(calloc(count, sizeof(GetManyElement)));
+    addMalloc(malloc_list, elements, count, sizeof(GetManyElement),
+              element_type_name);
+    return elements;
+}
+
+/**
+ * @brief Move the mapped data of one element into its result structure
+ *
+ * Ownership of the data array is transferred, no copy is made. The element
+ * block is freed.
+ *
+ * @param result_element result structure to fill
+ * @param element requested IDS element path
+ * @param status mapping return code
+ * @param message failure description, eg. the exception the mapping threw
+ * @param element_block data_block the element was mapped into
+ * @param malloc_list plugin interface malloc log, all heap referenced by the
+ * result is registered for serialisation
+ */
+void take_element(GetManyElement& result_element, std::string_view element,
+                  int status, std::string_view message,
+                  DATA_BLOCK* element_block, LOGMALLOCLIST* malloc_list) {
+
+    result_element = GetManyElement{};
+    result_element.status = status;
+    result_element.element = new_string(element, malloc_list);
+
+    const auto type_size =
+        imas_json_plugin::uda_helpers::uda_type_size(element_block->data_type);
+    if (status == 0 && type_size > 0 && element_block->data != nullptr) {
+        result_element.data_type = element_block->data_type;
+        result_element.count = element_block->data_n;
+        result_element.data =
+            reinterpret_cast<unsigned char*>(element_block->data);
+        element_block->data = nullptr;
+        addMalloc(malloc_list, result_element.data,
+                  static_cast<int>(result_element.count * type_size),
+                  sizeof(unsigned char), "unsigned char");
+
+        result_element.rank = static_cast<int>(element_block->rank);
+        if (result_element.rank > 0 && element_block->dims != nullptr) {
+            result_element.shape = static_cast<int*>(
+                malloc(result_element.rank * sizeof(int)));
+            for (int i = 0; i < result_element.rank; ++i) {
+                result_element.shape[i] = element_block->dims[i].dim_n;
+            }
+            addMalloc(malloc_list, result_element.shape, result_element.rank,
+                      sizeof(int), "int");
+        }
+    } else if (status == 0) {
+        // Non-atomic data (eg. nested compound) not supported in a batch
+        result_element.status = 1;
+        message = "non-atomic data not supported by getmany";
+    }
+    result_element.message = new_string(message, malloc_list);
+
+    freeDataBlock(element_block);
+}
+
+/**
+ * @brief Return the filled element array as a JMP_GETMANY compound structure
+ *
+ * @param interface Top-level UDA plugin interface
+ * @param elements element array from new_elements
+ * @param count number of elements
+ * @return int error_code
+ */
+int set_return_result(IDAM_PLUGIN_INTERFACE* interface,
+                      GetManyElement* elements, int count) {
+
+    auto* result = static_cast<GetManyResult*>(malloc(sizeof(GetManyResult)));
+    result->count = count;
+    result->elements = elements;
+    addMalloc(interface->logmalloclist, result, 1, sizeof(GetManyResult),
+              result_type_name);
+
+    DATA_BLOCK* data_block = interface->data_block;
+    data_block->data_type = UDA_TYPE_COMPOUND;
+    data_block->rank = 0;
+    data_block->data_n = 1;
+    data_block->data = reinterpret_cast<char*>(result);
+    strcpy(data_block->data_desc, "JSON mapping plugin getmany result");
+    data_block->opaque_type = UDA_OPAQUE_TYPE_STRUCTURES;
+    data_block->opaque_count = 1;
+    data_block->opaque_block = static_cast<void*>(findUserDefinedType(
+        interface->userdefinedtypelist, result_type_name, 0));
+
+    return 0;
+}
+
+} // namespace JMP::getmany
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <clientserver/udaStructs.h>
+#include <plugins/pluginStructs.h>
+#include <string_view>
+
+namespace JMP::getmany {
+
+/**
+ * @brief One mapped IDS element of a getmany result (UDA compound type
+ * JMP_GETMANY_ELEMENT)
+ *
+ * data holds the raw bytes of the mapped data, to be interpreted through
+ * data_type, so every element keeps its native type. shape holds rank
+ * dimension lengths in UDA dims order.
+ */
+struct GetManyElement {
+    char* element;       // requested IDS element path
+    int status;          // mapping error code, 0 success
+    char* message;       // failure description, empty on success
+    int data_type;       // UDA_TYPE of data
+    int rank;            // number of dimensions
+    int count;           // number of elements of data_type in data
+    int* shape;          // [rank]
+    unsigned char* data; // [count * sizeof(data_type)]
+};
+
+/**
+ * @brief Top-level getmany result (UDA compound type JMP_GETMANY)
+ */
+struct GetManyResult {
+    int count;
+    GetManyElement* elements; // [count]
+};
+
+constexpr const char* element_type_name{"JMP_GETMANY_ELEMENT"};
+constexpr const char* result_type_name{"JMP_GETMANY"};
+
+void define_types(USERDEFINEDTYPELIST* type_list);
+
+GetManyElement* new_elements(int count, LOGMALLOCLIST* malloc_list);
+
+void take_element(GetManyElement& result_element, std::string_view element,
+                  int status, std::string_view message,
+                  DATA_BLOCK* element_block, LOGMALLOCLIST* malloc_list);
+
+int set_return_result(IDAM_PLUGIN_INTERFACE* interface,
+                      GetManyElement* elements, int count);
+
+} // namespace JMP::getmany
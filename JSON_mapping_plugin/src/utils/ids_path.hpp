@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string_view>
+
+namespace JMP::ids_path {
+
+/**
+ * @brief Views into a requested IDS element path, no allocation
+ *
+ * eg. magnetics/coil/#/current
+ *   ids:      magnetics
+ *   map_path: coil/#/current
+ *   suffix:   current
+ *   parent:   coil/#
+ *
+ * All members view the original element string, which must outlive them.
+ */
+struct IDSPath {
+    std::string_view ids;
+    std::string_view map_path;
+    std::string_view suffix;
+    std::string_view parent;
+};
+
+/**
+ * @brief Tokenise an IDS element path without copying it
+ *
+ * @param element full IDS element path, '/' separated
+ * @return IDSPath views of the IDS name, mapping key, signal suffix and
+ * mapping key without the suffix (fallback key). map_path and suffix are
+ * empty when the element holds no '/'
+ */
+constexpr IDSPath parse(std::string_view element) {
+
+    IDSPath path{};
+    const auto first_sep = element.find('/');
+    if (first_sep == std::string_view::npos) {
+        path.ids = element;
+        return path;
+    }
+    path.ids = element.substr(0, first_sep);
+    path.map_path = element.substr(first_sep + 1);
+
+    const auto last_sep = path.map_path.rfind('/');
+    if (last_sep == std::string_view::npos) {
+        path.suffix = path.map_path;
+        path.parent = path.map_path.substr(0, 0);
+    } else {
+        path.suffix = path.map_path.substr(last_sep + 1);
+        path.parent = path.map_path.substr(0, last_sep);
+    }
+    return path;
+}
+
+} // namespace JMP::ids_path
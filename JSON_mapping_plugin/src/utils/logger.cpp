@@ -0,0 +1,202 @@
+#include "utils/logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+namespace JMP::logging {
+
+namespace {
+
+constexpr size_t slot_mask{Logger::capacity - 1};
+static_assert((Logger::capacity & slot_mask) == 0,
+              "Logger capacity must be a power of two");
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+    case LogLevel::DEBUG:
+        return "DEBUG";
+    case LogLevel::INFO:
+        return "INFO";
+    case LogLevel::WARNING:
+        return "WARNING";
+    case LogLevel::ERROR:
+        return "ERROR";
+    default:
+        return "LOG_LEVEL NOT DEFINED";
+    }
+}
+
+} // namespace
+
+LogLevel parse_level(std::string_view name, LogLevel fallback) {
+
+    std::string upper{name};
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+    if (upper == "DEBUG") {
+        return LogLevel::DEBUG;
+    } else if (upper == "INFO") {
+        return LogLevel::INFO;
+    } else if (upper == "WARNING") {
+        return LogLevel::WARNING;
+    } else if (upper == "ERROR") {
+        return LogLevel::ERROR;
+    } else if (upper == "NONE") {
+        return LogLevel::NONE;
+    }
+    return fallback;
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : m_slots{new Slot[capacity]} {
+    for (size_t i = 0; i < capacity; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger() { close(); }
+
+/**
+ * @brief Open (append) the log file and start the writer thread, messages
+ * logged before opening are kept in the buffer
+ *
+ * @param file_path log file path, no-op if already open on this path
+ * @return true if the file is open
+ */
+bool Logger::open(const std::string& file_path) {
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running && file_path == m_file_path) {
+            return true;
+        }
+    }
+    close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file.open(file_path, std::ios_base::out | std::ios_base::app);
+    if (!m_file) {
+        return false;
+    }
+    m_file_path = file_path;
+    m_running = true;
+    m_writer = std::thread([this]() { run(); });
+    return true;
+}
+
+/**
+ * @brief Stop the writer thread, writing any buffered messages, and close the
+ * log file
+ */
+void Logger::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_cv.notify_all();
+    m_writer.join();
+    m_file.close();
+    m_file_path.clear();
+}
+
+/**
+ * @brief Queue a message for the writer thread, never blocks
+ *
+ * @param level message level
+ * @param msg message, truncated to max_msg_length
+ * @return false if below the level threshold or the buffer is full
+ */
+bool Logger::log(LogLevel level, std::string_view msg) {
+
+    if (!enabled(level)) {
+        return false;
+    }
+
+    size_t pos{m_head.load(std::memory_order_relaxed)};
+    Slot* slot{nullptr};
+    while (true) {
+        slot = &m_slots[pos & slot_mask];
+        const size_t sequence{slot->sequence.load(std::memory_order_acquire)};
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+            // Slot free for this lap, claim it
+            if (m_head.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Writer a full lap behind, drop rather than block the request
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->time = std::chrono::system_clock::now();
+    slot->length = static_cast<uint16_t>(std::min(msg.size(), max_msg_length));
+    std::memcpy(slot->text.data(), msg.data(), slot->length);
+    // Publish to the writer
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Write all published messages, single consumer (writer thread)
+ *
+ * @return size_t number of messages written
+ */
+size_t Logger::drain() {
+
+    size_t count{0};
+    char timestamp[32];
+    while (true) {
+        Slot& slot = m_slots[m_tail & slot_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+            break;
+        }
+
+        const std::time_t time =
+            std::chrono::system_clock::to_time_t(slot.time);
+        std::tm time_utc{};
+        gmtime_r(&time, &time_utc);
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d:%H:%M:%S",
+                      &time_utc);
+        m_file << timestamp << ':' << level_name(slot.level) << " - ";
+        m_file.write(slot.text.data(), slot.length);
+        m_file << '\n';
+
+        // Release the slot for the next lap
+        slot.sequence.store(m_tail + capacity, std::memory_order_release);
+        ++m_tail;
+        ++count;
+    }
+    if (count > 0) {
+        m_file.flush();
+    }
+    return count;
+}
+
+void Logger::run() {
+
+    using namespace std::chrono_literals;
+    while (m_running) {
+        if (drain() == 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, 50ms, [this]() { return !m_running; });
+        }
+    }
+    drain();
+}
+
+} // namespace JMP::logging
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace JMP::logging {
+
+enum class LogLevel : uint8_t { DEBUG, INFO, WARNING, ERROR, NONE };
+
+/**
+ * @brief Parse a log level name (DEBUG, INFO, WARNING, ERROR, NONE), case
+ * insensitive
+ *
+ * @param name level name
+ * @param fallback level returned for unrecognised names
+ * @return LogLevel parsed level
+ */
+LogLevel parse_level(std::string_view name, LogLevel fallback);
+
+/**
+ * @class Logger
+ * @brief Asynchronous, buffered plugin log file writer
+ *
+ * Callers copy their message into a fixed size slot of a bounded lock-free
+ * ring buffer (multi-producer, sequence numbered slots) and return
+ * immediately. A single background thread keeps the log file open, drains
+ * the buffer in batches and flushes once per batch. Messages below the
+ * runtime level threshold are rejected with a single atomic load. When the
+ * buffer is full messages are dropped and counted rather than blocking the
+ * request.
+ */
+class Logger {
+  public:
+    static constexpr size_t capacity{1024};     // slots, power of two
+    static constexpr size_t max_msg_length{240}; // longer messages truncated
+
+    static Logger& instance();
+
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    bool open(const std::string& file_path);
+    void close();
+
+    void set_level(LogLevel level) {
+        m_level.store(level, std::memory_order_relaxed);
+    }
+    [[nodiscard]] LogLevel level() const {
+        return m_level.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] bool enabled(LogLevel level) const {
+        return level != LogLevel::NONE && level >= this->level();
+    }
+    [[nodiscard]] uint64_t dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    bool log(LogLevel level, std::string_view msg);
+
+  private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogLevel level{LogLevel::INFO};
+        std::chrono::system_clock::time_point time;
+        uint16_t length{0};
+        std::array<char, max_msg_length> text{};
+    };
+
+    void run();
+    size_t drain();
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<size_t> m_head{0}; // next slot to write
+    alignas(64) size_t m_tail{0};              // next slot to read (writer)
+    std::atomic<LogLevel> m_level{LogLevel::INFO};
+    std::atomic<uint64_t> m_dropped{0};
+
+    std::ofstream m_file;
+    std::string m_file_path;
+    std::thread m_writer;
+    std::mutex m_mutex; // guards open/close and writer sleep only
+    std::condition_variable m_cv;
+    std::atomic<bool> m_running{false};
+};
+
+/**
+ * @brief Log a message through the plugin logger
+ *
+ * @param level message level, rejected if below the runtime threshold
+ * @param msg message, copied
+ * @return true if queued
+ */
+inline bool log(LogLevel level, std::string_view msg) {
+    return Logger::instance().log(level, msg);
+}
+
+} // namespace JMP::logging
@@ -1,152 +1,217 @@
 #include "utils/scale_offset.hpp"
+#include "utils/uda_type_traits.hpp"
 #include <clientserver/udaTypes.h>
+#include <cstdlib>
 #include <logging/logging.h>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+#define JMP_SCALE_OFFSET_X86
+#include <immintrin.h>
+#endif
 
 namespace JMP::map_transform {
 
-int transform_offset(DataBlock* data_block, float offset) {
+namespace {
 
-    int err{1};
-    if (data_block->rank > 0) {
-        const size_t array_size(data_block->data_n);
-        switch (data_block->data_type) {
-        case UDA_TYPE_SHORT: {
-            auto* data = reinterpret_cast<short*>(data_block->data);
-            err = offset_span(gsl::span{data, array_size}, offset);
-            break;
-        }
-        case UDA_TYPE_INT: {
-            auto* data = reinterpret_cast<int*>(data_block->data);
-            err = offset_span(gsl::span{data, array_size}, offset);
-            break;
-        }
-        case UDA_TYPE_LONG: {
-            auto* data = reinterpret_cast<long*>(data_block->data);
-            err = offset_span(gsl::span{data, array_size}, offset);
-            break;
-        }
-        case UDA_TYPE_FLOAT: {
-            auto* data = reinterpret_cast<float*>(data_block->data);
-            err = offset_span(gsl::span{data, array_size}, offset);
-            break;
-        }
-        case UDA_TYPE_DOUBLE: {
-            auto* data = reinterpret_cast<double*>(data_block->data);
-            err = offset_span(gsl::span{data, array_size}, offset);
-            break;
-        }
-        default:
-            UDA_LOG(UDA_LOG_DEBUG,
-                    "\nOffsetEntry::transform(...) Unrecognised type\n");
-            return 1;
-        }
-    } else {
-        switch (data_block->data_type) {
-        case UDA_TYPE_SHORT: {
-            auto* data = reinterpret_cast<short*>(data_block->data);
-            err = offset_value(data, offset);
-            break;
-        }
-        case UDA_TYPE_INT: {
-            auto* data = reinterpret_cast<int*>(data_block->data);
-            err = offset_value(data, offset);
-            break;
-        }
-        case UDA_TYPE_LONG: {
-            auto* data = reinterpret_cast<long*>(data_block->data);
-            err = offset_value(data, offset);
-            break;
-        }
-        case UDA_TYPE_FLOAT: {
-            auto* data = reinterpret_cast<float*>(data_block->data);
-            err = offset_value(data, offset);
-            break;
-        }
-        case UDA_TYPE_DOUBLE: {
-            auto* data = reinterpret_cast<double*>(data_block->data);
-            err = offset_value(data, offset);
-            break;
-        }
-        default:
-            UDA_LOG(UDA_LOG_DEBUG,
-                    "\nOffsetEntry::transform(...) Unrecognised type\n");
-            break;
-        }
+#ifdef JMP_SCALE_OFFSET_X86
+
+/*
+ * Explicit kernels, compiled for their instruction set via target attributes
+ * and only called once simd_level() has confirmed CPU support. Tails are
+ * handled by the portable loop.
+ *
+ * Like scale_offset_scalar, every kernel computes in double with a separate
+ * multiply and add (no FMA) and converts back to the data type, so a signal
+ * maps to the same bits whichever kernel the CPU selects.
+ */
+
+__attribute__((target("avx2"))) void
+scale_offset_avx2(float* data, size_t count, double scale, double offset) {
+    const __m256d v_scale = _mm256_set1_pd(scale);
+    const __m256d v_offset = _mm256_set1_pd(offset);
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        const __m256d x = _mm256_cvtps_pd(_mm_loadu_ps(data + i));
+        const __m256d y = _mm256_add_pd(_mm256_mul_pd(x, v_scale), v_offset);
+        _mm_storeu_ps(data + i, _mm256_cvtpd_ps(y));
     }
+    scale_offset_scalar(data + i, data + i, count - i, scale, offset);
+}
 
-    return err;
+__attribute__((target("avx2"))) void
+scale_offset_avx2(double* data, size_t count, double scale, double offset) {
+    const __m256d v_scale = _mm256_set1_pd(scale);
+    const __m256d v_offset = _mm256_set1_pd(offset);
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        const __m256d x = _mm256_loadu_pd(data + i);
+        _mm256_storeu_pd(data + i,
+                         _mm256_add_pd(_mm256_mul_pd(x, v_scale), v_offset));
+    }
+    scale_offset_scalar(data + i, data + i, count - i, scale, offset);
 }
 
-int transform_scale(DataBlock* data_block, float scale) {
+// int data is calibrated in double precision and truncated back
+__attribute__((target("avx2"))) void
+scale_offset_avx2(int* data, size_t count, double scale, double offset) {
+    const __m256d v_scale = _mm256_set1_pd(scale);
+    const __m256d v_offset = _mm256_set1_pd(offset);
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        auto* ptr = reinterpret_cast<__m128i*>(data + i);
+        const __m256d x = _mm256_cvtepi32_pd(_mm_loadu_si128(ptr));
+        const __m256d y = _mm256_add_pd(_mm256_mul_pd(x, v_scale), v_offset);
+        _mm_storeu_si128(ptr, _mm256_cvttpd_epi32(y));
+    }
+    scale_offset_scalar(data + i, data + i, count - i, scale, offset);
+}
 
-    int err{1};
-    if (data_block->rank > 0) {
-        const size_t array_size(data_block->data_n);
-        switch (data_block->data_type) {
-        case UDA_TYPE_SHORT: {
-            auto* data = reinterpret_cast<short*>(data_block->data);
-            err = scale_span(gsl::span{data, array_size}, scale);
-            break;
-        }
-        case UDA_TYPE_INT: {
-            auto* data = reinterpret_cast<int*>(data_block->data);
-            err = scale_span(gsl::span{data, array_size}, scale);
-            break;
-        }
-        case UDA_TYPE_LONG: {
-            auto* data = reinterpret_cast<long*>(data_block->data);
-            err = scale_span(gsl::span{data, array_size}, scale);
-            break;
-        }
-        case UDA_TYPE_FLOAT: {
-            auto* data = reinterpret_cast<float*>(data_block->data);
-            err = scale_span(gsl::span{data, array_size}, scale);
-            break;
-        }
-        case UDA_TYPE_DOUBLE: {
-            auto* data = reinterpret_cast<double*>(data_block->data);
-            err = scale_span(gsl::span{data, array_size}, scale);
-            break;
-        }
-        default:
-            UDA_LOG(UDA_LOG_DEBUG,
-                    "\nOffsetEntry::transform(...) Unrecognised type\n");
-            return 1;
-        }
-    } else {
-        switch (data_block->data_type) {
-        case UDA_TYPE_SHORT: {
-            auto* data = reinterpret_cast<short*>(data_block->data);
-            err = scale_value(data, scale);
-            break;
-        }
-        case UDA_TYPE_INT: {
-            auto* data = reinterpret_cast<int*>(data_block->data);
-            err = scale_value(data, scale);
-            break;
-        }
-        case UDA_TYPE_LONG: {
-            auto* data = reinterpret_cast<long*>(data_block->data);
-            err = scale_value(data, scale);
-            break;
-        }
-        case UDA_TYPE_FLOAT: {
-            auto* data = reinterpret_cast<float*>(data_block->data);
-            err = scale_value(data, scale);
-            break;
-        }
-        case UDA_TYPE_DOUBLE: {
-            auto* data = reinterpret_cast<double*>(data_block->data);
-            err = scale_value(data, scale);
-            break;
-        }
+__attribute__((target("avx512f"))) void
+scale_offset_avx512(float* data, size_t count, double scale, double offset) {
+    const __m512d v_scale = _mm512_set1_pd(scale);
+    const __m512d v_offset = _mm512_set1_pd(offset);
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        const __m512d x = _mm512_cvtps_pd(_mm256_loadu_ps(data + i));
+        const __m512d y = _mm512_add_pd(_mm512_mul_pd(x, v_scale), v_offset);
+        _mm256_storeu_ps(data + i, _mm512_cvtpd_ps(y));
+    }
+    scale_offset_scalar(data + i, data + i, count - i, scale, offset);
+}
+
+__attribute__((target("avx512f"))) void
+scale_offset_avx512(double* data, size_t count, double scale, double offset) {
+    const __m512d v_scale = _mm512_set1_pd(scale);
+    const __m512d v_offset = _mm512_set1_pd(offset);
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        const __m512d x = _mm512_loadu_pd(data + i);
+        _mm512_storeu_pd(data + i,
+                         _mm512_add_pd(_mm512_mul_pd(x, v_scale), v_offset));
+    }
+    scale_offset_scalar(data + i, data + i, count - i, scale, offset);
+}
+
+__attribute__((target("avx512f"))) void
+scale_offset_avx512(int* data, size_t count, double scale, double offset) {
+    const __m512d v_scale = _mm512_set1_pd(scale);
+    const __m512d v_offset = _mm512_set1_pd(offset);
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        auto* ptr = reinterpret_cast<__m256i*>(data + i);
+        const __m512d x =
+            _mm512_maskz_cvtepi32_pd(0xFF, _mm256_loadu_si256(ptr));
+        const __m512d y = _mm512_add_pd(_mm512_mul_pd(x, v_scale), v_offset);
+        _mm256_storeu_si256(ptr, _mm512_maskz_cvttpd_epi32(0xFF, y));
+    }
+    scale_offset_scalar(data + i, data + i, count - i, scale, offset);
+}
+
+#endif // JMP_SCALE_OFFSET_X86
+
+/**
+ * @brief Types calibrated by transform_scale_offset
+ */
+template <typename T>
+inline constexpr bool is_calibrated_type_v =
+    std::is_same_v<T, short> || std::is_same_v<T, int> ||
+    std::is_same_v<T, long> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double>;
+
+/**
+ * @brief In-place fused scale/offset of one typed array, dispatching to the
+ * widest kernel available for T
+ */
+template <typename T>
+void scale_offset_inplace(T* data, size_t count, float scale, float offset) {
+#ifdef JMP_SCALE_OFFSET_X86
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> ||
+                  std::is_same_v<T, int>) {
+        switch (simd_level()) {
+        case SimdLevel::AVX512:
+            scale_offset_avx512(data, count, scale, offset);
+            return;
+        case SimdLevel::AVX2:
+            scale_offset_avx2(data, count, scale, offset);
+            return;
         default:
-            UDA_LOG(UDA_LOG_DEBUG,
-                    "\nOffsetEntry::transform(...) Unrecognised type\n");
             break;
         }
     }
+#endif
+    scale_offset_scalar(data, data, count, scale, offset);
+}
+
+/**
+ * @brief Fused scale/offset of data_block data, in place or into a new
+ * double array when promote_double
+ */
+template <typename T>
+int scale_offset_block(DataBlock* data_block, float scale, float offset,
+                       bool promote_double) {
+
+    auto* data = reinterpret_cast<T*>(data_block->data);
+    const auto count = static_cast<size_t>(data_block->data_n);
+    if (!promote_double || std::is_same_v<T, double>) {
+        scale_offset_inplace(data, count, scale, offset);
+        return 0;
+    }
+
+    auto* promoted = static_cast<double*>(malloc(count * sizeof(double)));
+    if (promoted == nullptr) {
+        return 1;
+    }
+    scale_offset_scalar(data, promoted, count, scale, offset);
+    free(data_block->data);
+    data_block->data = reinterpret_cast<char*>(promoted);
+    data_block->data_type = UDA_TYPE_DOUBLE;
+    return 0;
+}
+
+} // namespace
+
+SimdLevel simd_level() {
+    static const SimdLevel level = []() {
+#ifdef JMP_SCALE_OFFSET_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+#endif
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+}
+
+int transform_scale_offset(DataBlock* data_block, float scale, float offset,
+                           bool promote_double) {
+
+    if (data_block->data == nullptr || data_block->data_n <= 0) {
+        return 1;
+    }
 
+    const int err = imas_json_plugin::uda_helpers::visit_uda_type(
+        data_block->data_type, [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            if constexpr (is_calibrated_type_v<T>) {
+                return scale_offset_block<T>(data_block, scale, offset,
+                                             promote_double);
+            } else {
+                return -1;
+            }
+        },
+        -1);
+    if (err < 0) {
+        UDA_LOG(UDA_LOG_DEBUG,
+                "\ntransform_scale_offset(...) Unrecognised type\n");
+        return 1;
+    }
     return err;
 }
+
 } // namespace JMP::map_transform
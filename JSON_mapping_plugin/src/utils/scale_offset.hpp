@@ -1,45 +1,56 @@
-#include "gsl/gsl-lite.hpp"
+#pragma once
+
 #include <clientserver/udaStructs.h>
+#include <cstddef>
 
 namespace JMP::map_transform {
 
-int transform_offset(DataBlock* data_block, float offset);
-int transform_scale(DataBlock* data_block, float scale);
-
-template <typename T> int offset_value(T& temp_var, float offset) {
-
-    *temp_var += offset;
-    return 0;
-};
-
-template <typename T> int offset_span(gsl::span<T> temp_span, float offset) {
-
-    if (temp_span.empty()) {
-        return 1;
-    }
-
-    std::for_each(temp_span.begin(), temp_span.end(),
-                  [&offset](T& elem) { elem += offset; });
-
-    return 0;
-};
-
-template <typename T> int scale_value(T& temp_var, float scale) {
-
-    *temp_var *= scale;
-    return 0;
-};
-
-template <typename T> int scale_span(gsl::span<T> temp_span, float scale) {
-
-    if (temp_span.empty()) {
-        return 1;
+/**
+ * @brief Instruction set used by the fused scale/offset kernels, detected
+ * once at runtime
+ */
+enum class SimdLevel { SCALAR, AVX2, AVX512 };
+
+SimdLevel simd_level();
+
+/**
+ * @brief Fused calibration of the data_block data, y = x * scale + offset,
+ * in a single pass
+ *
+ * Short, int, long, float and double data are supported. Float, double and
+ * int data use explicit AVX2/AVX-512 kernels when the CPU supports them.
+ * Every path computes in double without FMA and converts back, so results
+ * are bit-identical whichever kernel is selected.
+ *
+ * @param data_block data_block holding the data, transformed in place
+ * @param scale multiplicative factor (1 for offset only)
+ * @param offset additive offset (0 for scale only)
+ * @param promote_double write the result into a new double array and set
+ * the data_block type to UDA_TYPE_DOUBLE, avoiding truncation of integer
+ * data and float rounding
+ * @return int error_code, 1 for empty data or unsupported types
+ */
+int transform_scale_offset(DataBlock* data_block, float scale, float offset,
+                           bool promote_double = false);
+
+/**
+ * @brief Portable scale/offset loop, used for types without an explicit SIMD
+ * kernel and for the tails of the SIMD kernels
+ *
+ * @tparam T input element type
+ * @tparam Out output element type
+ * @param in input array
+ * @param out output array, may alias in when T == Out
+ * @param count number of elements
+ * @param scale multiplicative factor
+ * @param offset additive offset
+ */
+template <typename T, typename Out = T>
+void scale_offset_scalar(const T* in, Out* out, size_t count, double scale,
+                         double offset) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<Out>(in[i] * scale + offset);
     }
-
-    std::for_each(temp_span.begin(), temp_span.end(),
-                  [&scale](T& elem) { elem *= scale; });
-
-    return 0;
-};
+}
 
 } // namespace JMP::map_transform
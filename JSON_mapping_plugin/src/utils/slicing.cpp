@@ -0,0 +1,339 @@
+#include "utils/slicing.hpp"
+#include "utils/uda_type_traits.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <clientserver/compressDim.h>
+#include <cstdlib>
+
+namespace JMP::map_transform {
+
+namespace {
+
+bool parse_int(std::string_view text, int& value) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && text.back() == ' ') {
+        text.remove_suffix(1);
+    }
+    const auto* const end = text.data() + text.size();
+    const auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+bool is_blank(std::string_view text) {
+    return text.find_first_not_of(' ') == std::string_view::npos;
+}
+
+int resolve_bound(int bound, size_t dim_n) {
+    const auto n = static_cast<long>(dim_n);
+    const long resolved{bound < 0 ? bound + n : bound};
+    return static_cast<int>(std::clamp(resolved, 0L, n));
+}
+
+/**
+ * @brief Gather the selected elements to the front of the array
+ *
+ * The source offset of output element i is strictly increasing in i, so
+ * never below i, and every element is read before its slot is reused.
+ */
+template <typename T>
+void gather(T* array, const std::vector<size_t>& shape,
+            const std::vector<DimSelection>& selection) {
+
+    const size_t rank{shape.size()};
+    std::vector<size_t> strides(rank, 1);
+    for (size_t j = 1; j < rank; ++j) {
+        strides[j] = strides[j - 1] * shape[j - 1];
+    }
+
+    // Odometer over dims 1..rank-1, dims[0] copied as one strided run
+    std::vector<size_t> counter(rank, 0);
+    const auto& inner = selection[0];
+    size_t out{0};
+    while (true) {
+        size_t base{inner.start};
+        for (size_t j = 1; j < rank; ++j) {
+            base += (selection[j].start + counter[j] * selection[j].step) *
+                    strides[j];
+        }
+        for (size_t k = 0; k < inner.count; ++k) {
+            array[out++] = array[base + k * inner.step];
+        }
+        size_t j{1};
+        for (; j < rank; ++j) {
+            if (++counter[j] < selection[j].count) {
+                break;
+            }
+            counter[j] = 0;
+        }
+        if (j >= rank) {
+            break;
+        }
+    }
+}
+
+int gather_array(char* array, int data_type, const std::vector<size_t>& shape,
+                 const std::vector<DimSelection>& selection) {
+
+    if (array == nullptr) {
+        return 0;
+    }
+    return imas_json_plugin::uda_helpers::visit_uda_type(
+        data_type, [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            gather(reinterpret_cast<T*>(array), shape, selection);
+            return 0;
+        });
+}
+
+/**
+ * @brief Whether gather_array can slice the array, null arrays are skipped
+ */
+bool can_gather(const char* array, int data_type) {
+    return array == nullptr || imas_json_plugin::uda_helpers::visit_uda_type(
+                                   data_type, [](auto) { return 0; }) == 0;
+}
+
+void free_dim(DIMS& dim) {
+    free(dim.dim);
+    free(dim.synthetic);
+    free(dim.errhi);
+    free(dim.errlo);
+    free(dim.sams);
+    free(dim.offs);
+    free(dim.ints);
+}
+
+/**
+ * @brief Prepare a kept dimension for slice_dim
+ *
+ * Compressed dimensions other than method 0 are uncompressed, which keeps
+ * their coordinates unchanged. Nothing is sliced here.
+ *
+ * @return int error_code, 1 if the dimension cannot be sliced
+ */
+int prepare_dim(DIMS& dim) {
+
+    if (dim.compressed && dim.method == 0) {
+        return 0;
+    }
+    if (dim.compressed) {
+        if (uncompressDim(&dim) != 0 || dim.dim == nullptr) {
+            return 1;
+        }
+        dim.compressed = 0;
+    }
+    return can_gather(dim.dim, dim.data_type) &&
+                   can_gather(dim.synthetic, dim.data_type) &&
+                   can_gather(dim.errhi, dim.error_type) &&
+                   can_gather(dim.errlo, dim.error_type)
+               ? 0
+               : 1;
+}
+
+/**
+ * @brief Restrict the coordinates of a kept dimension to its selection,
+ * which cannot fail once prepare_dim has succeeded
+ */
+void slice_dim(DIMS& dim, const DimSelection& selection) {
+
+    if (dim.compressed) {
+        dim.dim0 += static_cast<double>(selection.start) * dim.diff;
+        dim.diff *= static_cast<double>(selection.step);
+        dim.dim_n = static_cast<int>(selection.count);
+        return;
+    }
+
+    const std::vector<size_t> shape{static_cast<size_t>(dim.dim_n)};
+    const std::vector<DimSelection> dim_selection{selection};
+    gather_array(dim.dim, dim.data_type, shape, dim_selection);
+    gather_array(dim.synthetic, dim.data_type, shape, dim_selection);
+    gather_array(dim.errhi, dim.error_type, shape, dim_selection);
+    gather_array(dim.errlo, dim.error_type, shape, dim_selection);
+    dim.dim_n = static_cast<int>(selection.count);
+}
+
+} // namespace
+
+/**
+ * @brief Parse a single SLICE_INDEX entry, eg. "3", "-1", ":", "2:10:2"
+ *
+ * @param spec rendered slice index
+ * @param slice_spec [out] parsed selection
+ * @return int error_code, 1 if malformed or the step is not positive
+ */
+int parse_slice_spec(std::string_view spec, SliceSpec& slice_spec) {
+
+    slice_spec = SliceSpec{};
+    const auto first_colon = spec.find(':');
+    if (first_colon == std::string_view::npos) {
+        return parse_int(spec, slice_spec.start) ? 0 : 1;
+    }
+
+    slice_spec.is_index = false;
+    const auto start = spec.substr(0, first_colon);
+    auto rest = spec.substr(first_colon + 1);
+    const auto second_colon = rest.find(':');
+    const auto stop = rest.substr(0, second_colon);
+    const auto step = second_colon == std::string_view::npos
+                          ? std::string_view{}
+                          : rest.substr(second_colon + 1);
+
+    if (!is_blank(start) && !parse_int(start, slice_spec.start)) {
+        return 1;
+    }
+    if (!is_blank(stop)) {
+        if (!parse_int(stop, slice_spec.stop)) {
+            return 1;
+        }
+        slice_spec.has_stop = true;
+    }
+    if (!is_blank(step) && !parse_int(step, slice_spec.step)) {
+        return 1;
+    }
+    return slice_spec.step > 0 ? 0 : 1;
+}
+
+/**
+ * @brief Resolve the slice specs against a shape
+ *
+ * @param specs one selection per leading dimension
+ * @param shape dimension lengths in UDA dims order
+ * @param selection [out] one selection per dimension of shape
+ * @return int error_code, 1 for more specs than dimensions, an index out of
+ * range or an empty range
+ */
+int resolve_slice(const std::vector<SliceSpec>& specs,
+                  const std::vector<size_t>& shape,
+                  std::vector<DimSelection>& selection) {
+
+    if (specs.size() > shape.size()) {
+        return 1;
+    }
+    selection.clear();
+    selection.reserve(shape.size());
+    for (size_t j = 0; j < shape.size(); ++j) {
+        const auto dim_n = static_cast<long>(shape[j]);
+        if (j >= specs.size()) {
+            selection.push_back({0, 1, shape[j], false});
+            continue;
+        }
+        const auto& spec = specs[j];
+        if (spec.is_index) {
+            const long index{spec.start < 0 ? spec.start + dim_n : spec.start};
+            if (index < 0 || index >= dim_n) {
+                return 1;
+            }
+            selection.push_back({static_cast<size_t>(index), 1, 1, true});
+            continue;
+        }
+        const int start{resolve_bound(spec.start, shape[j])};
+        const int stop{spec.has_stop ? resolve_bound(spec.stop, shape[j])
+                                     : static_cast<int>(dim_n)};
+        if (stop <= start) {
+            return 1;
+        }
+        const auto count =
+            static_cast<size_t>((stop - start + spec.step - 1) / spec.step);
+        selection.push_back({static_cast<size_t>(start),
+                             static_cast<size_t>(spec.step), count, false});
+    }
+    return 0;
+}
+
+/**
+ * @brief Shape of a slice, without the indexed dimensions
+ *
+ * @param specs one selection per leading dimension
+ * @param shape dimension lengths in UDA dims order
+ * @param sliced_shape [out] shape of the slice
+ * @return int error_code
+ */
+int slice_shape(const std::vector<SliceSpec>& specs,
+                const std::vector<size_t>& shape,
+                std::vector<size_t>& sliced_shape) {
+
+    std::vector<DimSelection> selection;
+    if (resolve_slice(specs, shape, selection)) {
+        return 1;
+    }
+    sliced_shape.clear();
+    for (const auto& dim_selection : selection) {
+        if (!dim_selection.drop) {
+            sliced_shape.push_back(dim_selection.count);
+        }
+    }
+    return 0;
+}
+
+int slice_data_block(DataBlock* data_block,
+                     const std::vector<SliceSpec>& specs) {
+
+    if (data_block->data == nullptr || data_block->dims == nullptr ||
+        data_block->rank == 0) {
+        return 1;
+    }
+
+    std::vector<size_t> shape(data_block->rank);
+    for (unsigned int j = 0; j < data_block->rank; ++j) {
+        shape[j] = static_cast<size_t>(data_block->dims[j].dim_n);
+    }
+    std::vector<DimSelection> selection;
+    if (resolve_slice(specs, shape, selection)) {
+        return 1;
+    }
+
+    // Every check runs before the first buffer is touched, so a failure
+    // leaves the data_block as it was mapped
+    if (!can_gather(data_block->data, data_block->data_type) ||
+        !can_gather(data_block->synthetic, data_block->data_type) ||
+        !can_gather(data_block->errhi, data_block->error_type) ||
+        !can_gather(data_block->errlo, data_block->error_type)) {
+        return 1;
+    }
+    for (unsigned int j = 0; j < data_block->rank; ++j) {
+        if (!selection[j].drop && prepare_dim(data_block->dims[j])) {
+            return 1;
+        }
+    }
+
+    for (unsigned int j = 0; j < data_block->rank; ++j) {
+        if (!selection[j].drop) {
+            slice_dim(data_block->dims[j], selection[j]);
+        }
+    }
+    gather_array(data_block->data, data_block->data_type, shape, selection);
+    gather_array(data_block->synthetic, data_block->data_type, shape,
+                 selection);
+    gather_array(data_block->errhi, data_block->error_type, shape, selection);
+    gather_array(data_block->errlo, data_block->error_type, shape, selection);
+
+    size_t count{1};
+    unsigned int rank{0};
+    int order{-1};
+    for (unsigned int j = 0; j < data_block->rank; ++j) {
+        DIMS& dim = data_block->dims[j];
+        if (selection[j].drop) {
+            free_dim(dim);
+            continue;
+        }
+        if (static_cast<int>(j) == data_block->order) {
+            order = static_cast<int>(rank);
+        }
+        count *= selection[j].count;
+        data_block->dims[rank++] = dim;
+    }
+
+    data_block->data_n = static_cast<int>(count);
+    data_block->rank = rank;
+    data_block->order = order;
+    if (rank == 0) {
+        free(data_block->dims);
+        data_block->dims = nullptr;
+    }
+    return 0;
+}
+
+} // namespace JMP::map_transform
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <clientserver/udaStructs.h>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace JMP::map_transform {
+
+/**
+ * @brief Selection along one dimension, either a single index (the
+ * dimension is dropped) or a start:stop:step range (the dimension is kept)
+ *
+ * Negative start and stop count from the end of the dimension, stop is
+ * exclusive and step must be positive.
+ */
+struct SliceSpec {
+    int start{0};
+    int stop{0};
+    int step{1};
+    bool has_stop{false};
+    bool is_index{true};
+};
+
+int parse_slice_spec(std::string_view spec, SliceSpec& slice_spec);
+
+/**
+ * @brief Selection of SliceSpec resolved against a dimension length
+ */
+struct DimSelection {
+    size_t start{0};
+    size_t step{1};
+    size_t count{0};
+    bool drop{false};
+};
+
+int resolve_slice(const std::vector<SliceSpec>& specs,
+                  const std::vector<size_t>& shape,
+                  std::vector<DimSelection>& selection);
+
+int slice_shape(const std::vector<SliceSpec>& specs,
+                const std::vector<size_t>& shape,
+                std::vector<size_t>& sliced_shape);
+
+/**
+ * @brief Slice the data_block in place
+ *
+ * Spec j applies to UDA dimension j (dims[0] varies fastest), dimensions
+ * without a spec are kept whole. Data, error and synthetic arrays are
+ * gathered straight into the front of their existing buffers, dispatched
+ * on their UDA type, and the dimensions are updated: indexed dimensions are
+ * dropped, ranged dimensions keep the selected coordinates.
+ *
+ * @param data_block mapped data_block, replaced by the slice
+ * @param specs one selection per leading dimension
+ * @return int error_code, 1 for non-atomic data, more specs than
+ * dimensions or an out of range selection
+ */
+int slice_data_block(DataBlock* data_block,
+                     const std::vector<SliceSpec>& specs);
+
+} // namespace JMP::map_transform
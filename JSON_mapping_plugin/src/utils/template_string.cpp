@@ -0,0 +1,47 @@
+#include "utils/template_string.hpp"
+
+namespace JMP::templating {
+
+inja::Environment& environment() {
+    static inja::Environment env;
+    return env;
+}
+
+bool has_template_syntax(std::string_view str) {
+    // inja default openers for expressions, statements, comments and
+    // line statements
+    return str.find("{{") != std::string_view::npos or
+           str.find("{%") != std::string_view::npos or
+           str.find("{#") != std::string_view::npos or
+           str.find("##") != std::string_view::npos;
+}
+
+TemplateString::TemplateString(std::string source)
+    : m_source{std::move(source)},
+      m_is_template{has_template_syntax(m_source)} {
+    if (m_is_template) {
+        m_template = environment().parse(m_source);
+    }
+}
+
+/**
+ * @brief Render the pre-parsed template against the IDS globals
+ *
+ * @param json_globals global JSON object used in templating
+ * @return std::string rendered string, the source string if not a template
+ */
+std::string TemplateString::render(const nlohmann::json& json_globals) const {
+
+    if (!m_is_template) {
+        return m_source;
+    }
+
+    auto rendered = environment().render(m_template, json_globals);
+    // Globals may themselves contain templates, only re-parse when needed
+    if (has_template_syntax(rendered)) {
+        rendered = environment().render(rendered, json_globals);
+    }
+    return rendered;
+}
+
+} // namespace JMP::templating
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <inja/inja.hpp>
+#include <nlohmann/json.hpp>
+
+namespace JMP::templating {
+
+/**
+ * @brief Shared inja environment used to parse and render all mapping
+ * templates, default delimiters are used
+ *
+ * @return inja::Environment& environment reference (static lifetime)
+ */
+inja::Environment& environment();
+
+/**
+ * @brief Check whether a string contains any inja delimiters and therefore
+ * needs rendering
+ *
+ * @param str string to check
+ * @return true if an expression, statement, comment or line statement opener
+ * is present
+ */
+bool has_template_syntax(std::string_view str);
+
+/**
+ * @class TemplateString
+ * @brief Mapping string parsed into an inja AST once, at mapping load time
+ *
+ * Strings from the JSON mapping files may hold inja templates (eg.
+ * {{ indices.0 }}) which are rendered against the IDS globals per request.
+ * The template is parsed on construction so the request path only renders.
+ * Plain strings skip inja entirely. Rendering is performed twice when the
+ * first pass produces template syntax from the globals themselves, keeping
+ * the original double-render behaviour.
+ */
+class TemplateString {
+  public:
+    TemplateString() = default;
+    explicit TemplateString(std::string source);
+
+    [[nodiscard]] std::string render(const nlohmann::json& json_globals) const;
+    [[nodiscard]] const std::string& source() const { return m_source; }
+    [[nodiscard]] bool is_template() const { return m_is_template; }
+
+  private:
+    std::string m_source;
+    bool m_is_template{false};
+    inja::Template m_template;
+};
+
+} // namespace JMP::templating
@@ -32,4 +32,55 @@ int setReturnTimeArray(DATA_BLOCK* data_block) {
     return 0;
 };
 
+size_t initArrayBlock(DATA_BLOCK* data_block, gsl::span<const size_t> shape,
+                      const char* description) {
+
+    initDataBlock(data_block);
+
+    if (description != nullptr) {
+        strncpy(data_block->data_desc, description, STRING_LENGTH);
+        data_block->data_desc[STRING_LENGTH - 1] = '\0';
+    }
+
+    const auto rank{shape.size()};
+    data_block->rank = rank;
+    data_block->dims =
+        rank > 0 ? static_cast<DIMS*>(malloc(rank * sizeof(DIMS))) : nullptr;
+
+    size_t len = 1;
+
+    for (size_t i = 0; i < rank; ++i) {
+        initDimBlock(&data_block->dims[i]);
+
+        data_block->dims[i].data_type = UDA_TYPE_UNSIGNED_INT;
+        data_block->dims[i].dim_n = static_cast<int>(shape[i]);
+
+        // Always setting the dim to compressed initial value and spacing
+        data_block->dims[i].compressed = 1;
+        data_block->dims[i].dim0 = 0.0;
+        data_block->dims[i].diff = 1.0;
+        data_block->dims[i].method = 0;
+
+        len *= shape[i];
+    }
+    return len;
+}
+
+/**
+ * @brief Size in bytes of one element of an atomic UDA type
+ *
+ * @param data_type UDA_TYPE of the data
+ * @return size_t element size, 0 for non-atomic or unknown types
+ */
+size_t uda_type_size(int data_type) {
+
+    if (data_type == UDA_TYPE_STRING) {
+        return sizeof(char);
+    }
+    return visit_uda_type(
+        data_type,
+        [](auto tag) { return sizeof(typename decltype(tag)::type); },
+        size_t{0});
+}
+
 }; // namespace imas_json_plugin::uda_helpers
@@ -1,8 +1,7 @@
 #pragma once
 
+#include <algorithm>
 #include <cstring>
-#include <typeinfo>
-#include <unordered_map>
 #include <valarray>
 #include <vector>
 
@@ -11,15 +10,12 @@
 #include <clientserver/udaTypes.h>
 #include <gsl/gsl-lite.hpp>
 
-namespace imas_json_plugin::uda_helpers {
+#include "utils/uda_type_traits.hpp"
 
-inline std::unordered_map<std::string, UDA_TYPE> UDA_TYPE_MAP{
-    {typeid(unsigned int).name(), UDA_TYPE_UNSIGNED_INT},
-    {typeid(int).name(), UDA_TYPE_INT},
-    {typeid(float).name(), UDA_TYPE_FLOAT},
-    {typeid(double).name(), UDA_TYPE_DOUBLE}};
+namespace imas_json_plugin::uda_helpers {
 
 int setReturnTimeArray(DATA_BLOCK* data_block);
+size_t uda_type_size(int data_type);
 
 template <typename T>
 int setReturnDataScalarType(DATA_BLOCK* data_block, T value,
@@ -36,55 +32,88 @@ int setReturnDataScalarType(DATA_BLOCK* data_block, T value,
     }
 
     data_block->rank = 0;
-    data_block->data_type = UDA_TYPE_MAP.at(typeid(T).name());
+    data_block->data_type = uda_type_v<T>;
     data_block->data = reinterpret_cast<char*>(data);
     data_block->data_n = 1;
 
     return 0;
 };
 
+/**
+ * @brief Initialise data_block for an array of the given shape, with
+ * compressed index dimensions
+ *
+ * @return size_t number of elements
+ */
+size_t initArrayBlock(DATA_BLOCK* data_block, gsl::span<const size_t> shape,
+                      const char* description);
+
+/**
+ * @brief Allocate the data array of data_block for a producer to write into
+ * directly, the array is owned by the data_block
+ *
+ * @tparam T element type
+ * @param data_block data_block to initialise
+ * @param shape dimension lengths, in UDA dims order
+ * @param description optional data description
+ * @return T* uninitialised data array, nullptr if allocation fails
+ */
 template <typename T>
-int setReturnDataArrayType(DATA_BLOCK* data_block, gsl::span<const T> values,
-                           gsl::span<const size_t> shape,
-                           const char* description = nullptr) {
-
-    initDataBlock(data_block);
+T* allocReturnDataArray(DATA_BLOCK* data_block, gsl::span<const size_t> shape,
+                        const char* description = nullptr) {
 
-    if (description != nullptr) {
-        strncpy(data_block->data_desc, description, STRING_LENGTH);
-        data_block->data_desc[STRING_LENGTH - 1] = '\0';
+    const auto len = initArrayBlock(data_block, shape, description);
+    T* data = static_cast<T*>(malloc(std::max<size_t>(len, 1) * sizeof(T)));
+    if (data == nullptr) {
+        return nullptr;
     }
 
-    const auto rank{shape.size()};
-    data_block->rank = rank;
-    data_block->dims = (DIMS*)malloc(rank * sizeof(DIMS));
+    data_block->data_type = uda_type_v<T>;
+    data_block->data = reinterpret_cast<char*>(data);
+    data_block->data_n = static_cast<int>(len);
+    return data;
+}
 
-    size_t len = 1;
+template <typename T>
+T* allocReturnDataArray(DATA_BLOCK* data_block, size_t count,
+                        const char* description = nullptr) {
+    const size_t shape[]{count};
+    return allocReturnDataArray<T>(data_block, shape, description);
+}
 
-    for (size_t i = 0; i < rank; ++i) {
-        initDimBlock(&data_block->dims[i]);
+/**
+ * @brief Hand an already allocated array over to data_block, no copy is made
+ *
+ * @tparam T element type
+ * @param data_block data_block to initialise
+ * @param data malloc allocated array, ownership is transferred
+ * @param shape dimension lengths, in UDA dims order
+ * @param description optional data description
+ * @return int error_code
+ */
+template <typename T>
+int setReturnDataArrayOwned(DATA_BLOCK* data_block, T* data,
+                            gsl::span<const size_t> shape,
+                            const char* description = nullptr) {
 
-        int shape_i = shape[i];
-        data_block->dims[i].data_type = UDA_TYPE_UNSIGNED_INT;
+    const auto len = initArrayBlock(data_block, shape, description);
 
-        data_block->dims[i].dim_n = shape_i;
+    data_block->data_type = uda_type_v<T>;
+    data_block->data = reinterpret_cast<char*>(data);
+    data_block->data_n = static_cast<int>(len);
+    return 0;
+}
 
-        // Always setting the dim to compressed initial value and spacing
-        data_block->dims[i].compressed = 1;
-        data_block->dims[i].dim0 = 0.0;
-        data_block->dims[i].diff = 1.0;
-        data_block->dims[i].method = 0;
+template <typename T>
+int setReturnDataArrayType(DATA_BLOCK* data_block, gsl::span<const T> values,
+                           gsl::span<const size_t> shape,
+                           const char* description = nullptr) {
 
-        len *= shape_i;
+    T* data = allocReturnDataArray<T>(data_block, shape, description);
+    if (data == nullptr) {
+        return 1;
     }
-
-    T* data = static_cast<T*>(malloc(len * sizeof(T)));
     std::copy(values.begin(), values.end(), data);
-
-    data_block->data_type = UDA_TYPE_MAP.at(typeid(T).name());
-    data_block->data = reinterpret_cast<char*>(data);
-    data_block->data_n = (int)len; // Not ideal....
-
     return 0;
 };
 
@@ -93,36 +122,12 @@ int setReturnDataArrayType_Vec(DATA_BLOCK* data_block,
                                const std::vector<T>& vec_values,
                                const char* description = nullptr) {
 
-    initDataBlock(data_block);
-
-    if (description != nullptr) {
-        strncpy(data_block->data_desc, description, STRING_LENGTH);
-        data_block->data_desc[STRING_LENGTH - 1] = '\0';
+    T* data =
+        allocReturnDataArray<T>(data_block, vec_values.size(), description);
+    if (data == nullptr) {
+        return 1;
     }
-
-    const auto vec_size{vec_values.size()};
-    data_block->rank = 1;
-    data_block->dims = (DIMS*)malloc(1 * sizeof(DIMS));
-
-    initDimBlock(&data_block->dims[0]);
-
-    data_block->dims[0].data_type = UDA_TYPE_UNSIGNED_INT;
-
-    data_block->dims[0].dim_n = vec_size;
-
-    // Always setting the dim to compressed initial value and spacing
-    data_block->dims[0].compressed = 1;
-    data_block->dims[0].dim0 = 0.0;
-    data_block->dims[0].diff = 1.0;
-    data_block->dims[0].method = 0;
-
-    T* data = static_cast<T*>(malloc(vec_size * sizeof(T)));
     std::copy(vec_values.begin(), vec_values.end(), data);
-
-    data_block->data_type = UDA_TYPE_MAP.at(typeid(T).name());
-    data_block->data = reinterpret_cast<char*>(data);
-    data_block->data_n = (int)vec_size;
-
     return 0;
 };
 
@@ -131,36 +136,12 @@ int setReturnDataValArray(DATA_BLOCK* data_block,
                           const std::valarray<T>& va_values,
                           const char* description = nullptr) {
 
-    initDataBlock(data_block);
-
-    if (description != nullptr) {
-        strncpy(data_block->data_desc, description, STRING_LENGTH);
-        data_block->data_desc[STRING_LENGTH - 1] = '\0';
+    T* data =
+        allocReturnDataArray<T>(data_block, va_values.size(), description);
+    if (data == nullptr) {
+        return 1;
     }
-
-    const auto va_size{va_values.size()};
-    data_block->rank = 1;
-    data_block->dims = (DIMS*)malloc(1 * sizeof(DIMS));
-
-    initDimBlock(&data_block->dims[0]);
-
-    data_block->dims[0].data_type = UDA_TYPE_UNSIGNED_INT;
-
-    data_block->dims[0].dim_n = va_size;
-
-    // Always setting the dim to compressed initial value and spacing
-    data_block->dims[0].compressed = 1;
-    data_block->dims[0].dim0 = 0.0;
-    data_block->dims[0].diff = 1.0;
-    data_block->dims[0].method = 0;
-
-    T* data = static_cast<T*>(malloc(va_size * sizeof(T)));
     std::copy(std::begin(va_values), std::end(va_values), data);
-
-    data_block->data_type = UDA_TYPE_MAP.at(typeid(T).name());
-    data_block->data = reinterpret_cast<char*>(data);
-    data_block->data_n = (int)va_size;
-
     return 0;
 }
 
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <clientserver/udaTypes.h>
+#include <complex>
+#include <utility>
+
+namespace imas_json_plugin::uda_helpers {
+
+/**
+ * @brief UDA_TYPE of a C++ type, resolved at compile time
+ *
+ * Only types with a UDA equivalent are specialised, any other type is a
+ * compile error.
+ */
+template <typename T> struct uda_type_of {
+    static_assert(sizeof(T) == 0, "C++ type has no UDA_TYPE equivalent");
+};
+
+#define JMP_UDA_TYPE_OF(CPP_TYPE, UDA_TYPE_ID)                                 \
+    template <> struct uda_type_of<CPP_TYPE> {                                 \
+        static constexpr UDA_TYPE value{UDA_TYPE_ID};                          \
+    };
+
+JMP_UDA_TYPE_OF(char, UDA_TYPE_CHAR)
+JMP_UDA_TYPE_OF(unsigned char, UDA_TYPE_UNSIGNED_CHAR)
+JMP_UDA_TYPE_OF(short, UDA_TYPE_SHORT)
+JMP_UDA_TYPE_OF(unsigned short, UDA_TYPE_UNSIGNED_SHORT)
+JMP_UDA_TYPE_OF(int, UDA_TYPE_INT)
+JMP_UDA_TYPE_OF(unsigned int, UDA_TYPE_UNSIGNED_INT)
+JMP_UDA_TYPE_OF(long, UDA_TYPE_LONG)
+JMP_UDA_TYPE_OF(unsigned long, UDA_TYPE_UNSIGNED_LONG)
+JMP_UDA_TYPE_OF(long long, UDA_TYPE_LONG64)
+JMP_UDA_TYPE_OF(unsigned long long, UDA_TYPE_UNSIGNED_LONG64)
+JMP_UDA_TYPE_OF(float, UDA_TYPE_FLOAT)
+JMP_UDA_TYPE_OF(double, UDA_TYPE_DOUBLE)
+// Layout compatible with the UDA COMPLEX and DCOMPLEX structures
+JMP_UDA_TYPE_OF(std::complex<float>, UDA_TYPE_COMPLEX)
+JMP_UDA_TYPE_OF(std::complex<double>, UDA_TYPE_DCOMPLEX)
+
+#undef JMP_UDA_TYPE_OF
+
+template <typename T>
+inline constexpr UDA_TYPE uda_type_v = uda_type_of<T>::value;
+
+/**
+ * @brief Tag carrying the C++ type selected by visit_uda_type
+ */
+template <typename T> struct type_tag {
+    using type = T;
+};
+
+/**
+ * @brief Call a generic visitor with the C++ type of a runtime UDA_TYPE
+ *
+ * The visitor is invoked as visitor(type_tag<T>{}) for every atomic UDA
+ * type, so a single templated kernel replaces a switch per call site, eg.
+ *
+ *     visit_uda_type(data_block->data_type, [&](auto tag) {
+ *         using T = typename decltype(tag)::type;
+ *         return kernel<T>(...);
+ *     });
+ *
+ * @param data_type UDA_TYPE of the data
+ * @param visitor generic callable, every instantiation returns R
+ * @param unsupported returned for non-atomic or unknown types
+ * @return R result of the visitor, or unsupported
+ */
+template <typename Visitor, typename R = int>
+R visit_uda_type(int data_type, Visitor&& visitor, R unsupported = 1) {
+
+    switch (data_type) {
+    case UDA_TYPE_CHAR:
+        return visitor(type_tag<char>{});
+    case UDA_TYPE_UNSIGNED_CHAR:
+        return visitor(type_tag<unsigned char>{});
+    case UDA_TYPE_SHORT:
+        return visitor(type_tag<short>{});
+    case UDA_TYPE_UNSIGNED_SHORT:
+        return visitor(type_tag<unsigned short>{});
+    case UDA_TYPE_INT:
+        return visitor(type_tag<int>{});
+    case UDA_TYPE_UNSIGNED_INT:
+        return visitor(type_tag<unsigned int>{});
+    case UDA_TYPE_LONG:
+        return visitor(type_tag<long>{});
+    case UDA_TYPE_UNSIGNED_LONG:
+        return visitor(type_tag<unsigned long>{});
+    case UDA_TYPE_LONG64:
+        return visitor(type_tag<long long>{});
+    case UDA_TYPE_UNSIGNED_LONG64:
+        return visitor(type_tag<unsigned long long>{});
+    case UDA_TYPE_FLOAT:
+        return visitor(type_tag<float>{});
+    case UDA_TYPE_DOUBLE:
+        return visitor(type_tag<double>{});
+    case UDA_TYPE_COMPLEX:
+        return visitor(type_tag<std::complex<float>>{});
+    case UDA_TYPE_DCOMPLEX:
+        return visitor(type_tag<std::complex<double>>{});
+    default:
+        return unsupported;
+    }
+}
+
+} // namespace imas_json_plugin::uda_helpers
@@ -0,0 +1,48 @@
+#include "utils/worker_pool.hpp"
+
+namespace JMP::concurrency {
+
+namespace {
+// Pool the current thread works for, nullptr outside of any pool
+thread_local const WorkerPool* current_pool{nullptr};
+} // namespace
+
+WorkerPool::WorkerPool(size_t n_threads) {
+    m_threads.reserve(n_threads);
+    for (size_t i = 0; i < n_threads; ++i) {
+        m_threads.emplace_back([this]() { run(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool WorkerPool::in_worker() const { return current_pool == this; }
+
+void WorkerPool::run() {
+
+    current_pool = this;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+
+} // namespace JMP::concurrency
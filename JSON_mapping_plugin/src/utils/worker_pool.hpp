@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace JMP::concurrency {
+
+/**
+ * @class WorkerPool
+ * @brief Fixed size pool of worker threads executing queued tasks
+ *
+ * Runs the background source fetches queued by prefetch. Tasks submitted from a worker thread of the same pool are run
+ * inline, nested mappings therefore cannot deadlock waiting on the pool.
+ */
+class WorkerPool {
+  public:
+    explicit WorkerPool(size_t n_threads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    [[nodiscard]] size_t size() const { return m_threads.size(); }
+    [[nodiscard]] bool in_worker() const;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& func);
+
+  private:
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop{false};
+};
+
+template <typename F>
+std::future<std::invoke_result_t<F>> WorkerPool::submit(F&& func) {
+
+    using Result_t = std::invoke_result_t<F>;
+    // std::function requires copyable callables, share the packaged_task
+    auto task =
+        std::make_shared<std::packaged_task<Result_t()>>(std::forward<F>(func));
+    auto result = task->get_future();
+
+    if (m_threads.empty() || in_worker()) {
+        (*task)();
+        return result;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace([task]() { (*task)(); });
+    }
+    m_cv.notify_one();
+    return result;
+}
+
+} // namespace JMP::concurrency
@@ -0,0 +1,418 @@
+/*
+ * Benchmarks of the mapping hot path
+ *
+ * Drives the plugin entry point (JSONMappingPlugin::get) against synthetic
+ * mapping trees written to a temporary directory. PLUGIN entries are served
+ * by an in-process mock plugin registered in a local plugin list, so no UDA
+ * server or data source is needed. Build with CMAKE_BUILD_TYPE=Release and
+ * JSONMappingPlugin_ENABLE_BENCHMARKS=ON.
+ */
+#include "JSON_mapping_plugin.h"
+#include "handlers/mapping_handler.hpp"
+#include "utils/scale_offset.hpp"
+#include "utils/template_string.hpp"
+#include "utils/uda_plugin_helpers.hpp"
+
+#include <benchmark/benchmark.h>
+#include <clientserver/freeDataBlock.h>
+#include <clientserver/initStructs.h>
+#include <clientserver/stringUtils.h>
+#include <plugins/udaPlugin.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* bench_ids{"bench"};
+constexpr const char* imas_version{"3.37"};
+constexpr size_t n_samples{4096};
+constexpr size_t n_channels{64};
+
+/////////////////////////////////////////////////////////////////////////////
+// Mock data source
+/////////////////////////////////////////////////////////////////////////////
+
+const std::vector<float>& signal_values(size_t count) {
+    static const std::vector<float> values = [] {
+        std::vector<float> temp(n_channels * n_samples);
+        for (size_t i = 0; i < temp.size(); ++i) {
+            temp[i] = static_cast<float>(i % 1000) * 0.5f;
+        }
+        return temp;
+    }();
+    return count <= values.size() ? values : signal_values(values.size());
+}
+
+/**
+ * @brief Mock plugin, /bench/signal is a rank 1 float signal and
+ * /bench/signal2d a rank 2 (channel, time) float signal
+ */
+int mock_plugin(IDAM_PLUGIN_INTERFACE* interface) {
+
+    REQUEST_DATA* request_data = interface->request_data;
+    const char* signal{nullptr};
+    FIND_REQUIRED_STRING_VALUE(request_data->nameValueList, signal);
+
+    const bool is_2d{std::strcmp(signal, "/bench/signal2d") == 0};
+    const size_t shape[]{is_2d ? n_channels : n_samples, n_samples};
+    const size_t rank{is_2d ? 2UL : 1UL};
+
+    if (STR_IEQUALS(request_data->function, "shape")) {
+        int dims[]{static_cast<int>(shape[0]), static_cast<int>(shape[1])};
+        return setReturnDataIntArray(interface->data_block, dims, 1, &rank,
+                                     nullptr);
+    }
+    const auto& values = signal_values(is_2d ? n_channels * n_samples
+                                             : n_samples);
+    return setReturnDataFloatArray(interface->data_block,
+                                   const_cast<float*>(values.data()), rank,
+                                   shape, nullptr);
+}
+
+/**
+ * @brief Plugin list serving the UDA and DRaFT_JSON formats from the mock
+ */
+const PLUGINLIST* mock_plugin_list() {
+    static std::vector<PLUGIN_DATA> plugins = [] {
+        std::vector<PLUGIN_DATA> temp(2);
+        const char* formats[]{"UDA", "DRaFT_JSON"};
+        for (size_t i = 0; i < temp.size(); ++i) {
+            auto& plugin = temp[i];
+            std::memset(&plugin, 0, sizeof(PLUGIN_DATA));
+            std::strcpy(plugin.format, formats[i]);
+            std::strcpy(plugin.symbol, "mock_plugin");
+            plugin.request = 9000 + static_cast<int>(i);
+            plugin.plugin_class = UDA_PLUGIN_CLASS_FUNCTION;
+            plugin.external = UDA_PLUGIN_EXTERNAL;
+            plugin.status = UDA_PLUGIN_OPERATIONAL;
+            plugin.is_private = UDA_PLUGIN_PUBLIC;
+            plugin.interfaceVersion = 1;
+            plugin.idamPlugin = &mock_plugin;
+        }
+        return temp;
+    }();
+    static PLUGINLIST plugin_list{static_cast<int>(plugins.size()),
+                                  static_cast<int>(plugins.size()),
+                                  plugins.data()};
+    return &plugin_list;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Synthetic mapping trees
+/////////////////////////////////////////////////////////////////////////////
+
+fs::path bench_root() {
+    static const fs::path root = fs::temp_directory_path() /
+                                 ("jmp_bench_" + std::to_string(getpid()));
+    return root;
+}
+
+void write_json(const fs::path& file_path, const nlohmann::json& data) {
+    fs::create_directories(file_path.parent_path());
+    std::ofstream file(file_path);
+    file << data;
+}
+
+/**
+ * @brief Write a mapping directory holding the single IDS 'bench'
+ *
+ * @return fs::path mapping directory, as JSON_MAPPING_DIR
+ */
+fs::path write_mapping_dir(const std::string& name,
+                           const nlohmann::json& mappings) {
+    const auto map_dir = bench_root() / name;
+    write_json(map_dir / "mappings.cfg.json",
+               {{imas_version, std::vector<std::string>{bench_ids}}});
+    write_json(map_dir / "mappings" / bench_ids / "globals.json",
+               {{"prefix", "bench"}, {"scale", 2.0}});
+    write_json(map_dir / "mappings" / bench_ids / "mappings.json", mappings);
+    return map_dir;
+}
+
+/**
+ * @brief One entry of every MAP_TYPE, requested by the latency benchmarks
+ */
+nlohmann::json entry_mappings() {
+    nlohmann::json array(std::vector<float>(1024, 1.5f));
+    return {
+        {"value_scalar", {{"MAP_TYPE", "VALUE"}, {"VALUE", 3.5}}},
+        {"value_array", {{"MAP_TYPE", "VALUE"}, {"VALUE", array}}},
+        {"plugin",
+         {{"MAP_TYPE", "PLUGIN"},
+          {"PLUGIN", "UDA"},
+          {"ARGS", {{"signal", "/{{ prefix }}/signal"}}}}},
+        {"plugin_scaled",
+         {{"MAP_TYPE", "PLUGIN"},
+          {"PLUGIN", "UDA"},
+          {"ARGS", {{"signal", "/{{ prefix }}/signal"}}},
+          {"SCALE", 2.0},
+          {"OFFSET", 1.0}}},
+        {"plugin_2d",
+         {{"MAP_TYPE", "PLUGIN"},
+          {"PLUGIN", "DRaFT_JSON"},
+          {"ARGS", {{"signal", "/{{ prefix }}/signal2d"}}}}},
+        {"channel/#/data",
+         {{"MAP_TYPE", "SLICE"},
+          {"SLICE_INDEX", {"{{ indices.0 }}"}},
+          {"SIGNAL", "plugin_2d"}}},
+        {"expr",
+         {{"MAP_TYPE", "EXPR"},
+          {"EXPR", "X * {{ scale }} + Y"},
+          {"PARAMETERS", {{"X", "plugin"}, {"Y", "plugin_scaled"}}}}},
+        {"channel_count",
+         {{"MAP_TYPE", "DIMENSION"}, {"DIM_PROBE", "plugin_2d"}}},
+        {"custom",
+         {{"MAP_TYPE", "CUSTOM"}, {"CUSTOM_TYPE", "MASTU_helloworld"}}}};
+}
+
+/**
+ * @brief Mapping tree of n_entries entries cycling through the MAP_TYPEs,
+ * for the load time benchmark
+ */
+nlohmann::json sized_mappings(size_t n_entries) {
+    nlohmann::json mappings = nlohmann::json::object();
+    for (size_t i = 0; i < n_entries; ++i) {
+        const std::string key{"node_" + std::to_string(i)};
+        switch (i % 4) {
+        case 0:
+            mappings[key] = {{"MAP_TYPE", "VALUE"},
+                             {"VALUE", {1.0, 2.0, 3.0}}};
+            break;
+        case 1:
+            mappings[key] = {
+                {"MAP_TYPE", "PLUGIN"},
+                {"PLUGIN", "UDA"},
+                {"ARGS",
+                 {{"signal", "/{{ prefix }}/signal_{{ indices.0 }}"}}},
+                {"SCALE", "{{ scale }}"}};
+            break;
+        case 2:
+            mappings[key + "/#/data"] = {
+                {"MAP_TYPE", "SLICE"},
+                {"SLICE_INDEX", {"{{ indices.0 }}"}},
+                {"SIGNAL", "node_" + std::to_string(i - 1)}};
+            break;
+        default:
+            mappings[key] = {
+                {"MAP_TYPE", "EXPR"},
+                {"EXPR", "X + 1"},
+                {"PARAMETERS", {{"X", "node_" + std::to_string(i - 2)}}}};
+            break;
+        }
+    }
+    return mappings;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Plugin requests
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @class PluginRequest
+ * @brief Plugin interface and name-value list of one request, owning every
+ * string it points to
+ */
+class PluginRequest {
+  public:
+    PluginRequest(const char* function,
+                  std::vector<std::pair<std::string, std::string>> args)
+        : m_args{std::move(args)} {
+
+        m_name_values.resize(m_args.size());
+        for (size_t i = 0; i < m_args.size(); ++i) {
+            auto& [name, value] = m_args[i];
+            m_name_values[i].pair = nullptr;
+            m_name_values[i].name = name.data();
+            m_name_values[i].value = value.data();
+        }
+        std::memset(&m_request_data, 0, sizeof(REQUEST_DATA));
+        std::strcpy(m_request_data.function, function);
+        m_request_data.nameValueList.pairCount =
+            static_cast<int>(m_name_values.size());
+        m_request_data.nameValueList.listSize =
+            static_cast<int>(m_name_values.size());
+        m_request_data.nameValueList.nameValue = m_name_values.data();
+
+        initDataBlock(&m_data_block);
+        std::memset(&m_interface, 0, sizeof(IDAM_PLUGIN_INTERFACE));
+        m_interface.interfaceVersion = 1;
+        m_interface.data_block = &m_data_block;
+        m_interface.request_data = &m_request_data;
+        m_interface.pluginList = mock_plugin_list();
+    }
+    PluginRequest(const PluginRequest&) = delete;
+    PluginRequest& operator=(const PluginRequest&) = delete;
+    ~PluginRequest() { freeDataBlock(&m_data_block); }
+
+    int call() {
+        freeDataBlock(&m_data_block);
+        initDataBlock(&m_data_block);
+        return jsonMappingPlugin(&m_interface);
+    }
+    [[nodiscard]] const DATA_BLOCK& data_block() const {
+        return m_data_block;
+    }
+
+  private:
+    std::vector<std::pair<std::string, std::string>> m_args;
+    std::vector<NAMEVALUE> m_name_values;
+    REQUEST_DATA m_request_data;
+    DATA_BLOCK m_data_block;
+    IDAM_PLUGIN_INTERFACE m_interface;
+};
+
+/**
+ * @brief Point the plugin at the entry mapping tree, once per process
+ */
+void setup_plugin_environment() {
+    static const bool done = [] {
+        const auto map_dir = write_mapping_dir("entries", entry_mappings());
+        setenv("JSON_MAPPING_DIR", map_dir.c_str(), 1);
+        setenv("JSON_MAPPING_LOG_LEVEL", "NONE", 1);
+        setenv("JSON_MAPPING_LOAD_MODE", "EAGER", 1);
+        return true;
+    }();
+    (void)done;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Latency of one get request per MAP_TYPE, result cache disabled
+ */
+void BM_get(benchmark::State& state, const char* element) {
+
+    setup_plugin_environment();
+    setenv("JSON_MAPPING_CACHE_MB", "0", 1);
+    PluginRequest request("get", {{"IDS_version", imas_version},
+                                  {"element", element},
+                                  {"shot", "45460"},
+                                  {"dtype", "0"},
+                                  {"indices", "1"}});
+    for (auto _ : state) {
+        if (request.call() != 0) {
+            state.SkipWithError("get request failed");
+            break;
+        }
+        benchmark::DoNotOptimize(request.data_block().data);
+    }
+}
+BENCHMARK_CAPTURE(BM_get, VALUE_scalar, "bench/value_scalar");
+BENCHMARK_CAPTURE(BM_get, VALUE_array, "bench/value_array");
+BENCHMARK_CAPTURE(BM_get, PLUGIN, "bench/plugin");
+BENCHMARK_CAPTURE(BM_get, PLUGIN_scale_offset, "bench/plugin_scaled");
+BENCHMARK_CAPTURE(BM_get, EXPR, "bench/expr");
+BENCHMARK_CAPTURE(BM_get, SLICE, "bench/channel/#/data");
+BENCHMARK_CAPTURE(BM_get, DIMENSION, "bench/channel_count");
+BENCHMARK_CAPTURE(BM_get, CUSTOM, "bench/custom");
+
+/**
+ * @brief Latency of a repeated PLUGIN get served from the result cache
+ */
+void BM_get_cached(benchmark::State& state) {
+
+    setup_plugin_environment();
+    setenv("JSON_MAPPING_CACHE_MB", "256", 1);
+    PluginRequest request("get", {{"IDS_version", imas_version},
+                                  {"element", "bench/plugin"},
+                                  {"shot", "45460"},
+                                  {"dtype", "0"},
+                                  {"indices", "1"}});
+    for (auto _ : state) {
+        if (request.call() != 0) {
+            state.SkipWithError("get request failed");
+            break;
+        }
+        benchmark::DoNotOptimize(request.data_block().data);
+    }
+    setenv("JSON_MAPPING_CACHE_MB", "0", 1);
+}
+BENCHMARK(BM_get_cached);
+
+/**
+ * @brief MappingHandler load time against the mapping tree size
+ */
+void BM_load_mappings(benchmark::State& state) {
+
+    const auto n_entries = static_cast<size_t>(state.range(0));
+    const auto map_dir = write_mapping_dir(
+        "load_" + std::to_string(n_entries), sized_mappings(n_entries));
+    for (auto _ : state) {
+        MappingHandler handler{imas_version};
+        handler.set_map_dir(map_dir.string());
+        handler.set_load_mode(LoadMode::EAGER);
+        handler.init();
+        benchmark::DoNotOptimize(handler.read_mappings(bench_ids));
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<int64_t>(n_entries));
+}
+BENCHMARK(BM_load_mappings)
+    ->RangeMultiplier(4)
+    ->Range(64, 16384)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Rendering of a pre-parsed template against the request globals
+ */
+void BM_template_render(benchmark::State& state, const char* source) {
+
+    const JMP::templating::TemplateString template_string{source};
+    const nlohmann::json globals{
+        {"prefix", "bench"}, {"scale", 2.0}, {"indices", {3, 1}}};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(template_string.render(globals));
+    }
+}
+BENCHMARK_CAPTURE(BM_template_render, plain, "/bench/signal");
+BENCHMARK_CAPTURE(BM_template_render, indices,
+                  "/{{ prefix }}/channel_{{ indices.0 }}/{{ indices.1 }}");
+
+/**
+ * @brief Fused scale/offset throughput, in place
+ */
+template <typename T> void BM_scale_offset(benchmark::State& state) {
+
+    const auto count = static_cast<size_t>(state.range(0));
+    DATA_BLOCK data_block;
+    T* data = imas_json_plugin::uda_helpers::allocReturnDataArray<T>(
+        &data_block, count);
+    std::fill(data, data + count, T{1});
+    for (auto _ : state) {
+        JMP::map_transform::transform_scale_offset(&data_block, 1.0f, 0.0f);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<int64_t>(count * sizeof(T)));
+    freeDataBlock(&data_block);
+}
+BENCHMARK_TEMPLATE(BM_scale_offset, float)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_scale_offset, double)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_scale_offset, int)->Range(1 << 10, 1 << 22);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::error_code ec;
+    fs::remove_all(bench_root(), ec);
+    return 0;
+}
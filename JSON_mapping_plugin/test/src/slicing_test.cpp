@@ -0,0 +1,248 @@
+#include "utils/slicing.hpp"
+
+#include <clientserver/freeDataBlock.h>
+#include <clientserver/initStructs.h>
+#include <clientserver/udaTypes.h>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using JMP::map_transform::DimSelection;
+using JMP::map_transform::parse_slice_spec;
+using JMP::map_transform::resolve_slice;
+using JMP::map_transform::slice_data_block;
+using JMP::map_transform::slice_shape;
+using JMP::map_transform::SliceSpec;
+
+namespace {
+
+std::vector<SliceSpec> parse_specs(const std::vector<std::string>& specs) {
+    std::vector<SliceSpec> parsed(specs.size());
+    for (size_t i = 0; i < specs.size(); ++i) {
+        EXPECT_EQ(parse_slice_spec(specs[i], parsed[i]), 0) << specs[i];
+    }
+    return parsed;
+}
+
+template <typename T> T* new_array(size_t count) {
+    return static_cast<T*>(malloc(count * sizeof(T)));
+}
+
+/**
+ * @brief Rank 3 double data_block, data[i] = i, dims[0] varying fastest.
+ * dims[0] has a coordinate array (10 * index), dims[1] and dims[2] are
+ * compressed (method 0)
+ */
+void make_block(DATA_BLOCK& data_block, const std::vector<size_t>& shape) {
+    initDataBlock(&data_block);
+    data_block.rank = static_cast<unsigned int>(shape.size());
+    data_block.data_type = UDA_TYPE_DOUBLE;
+    data_block.data_n = 1;
+    data_block.dims = new_array<DIMS>(shape.size());
+    for (size_t j = 0; j < shape.size(); ++j) {
+        DIMS& dim = data_block.dims[j];
+        initDimBlock(&dim);
+        dim.dim_n = static_cast<int>(shape[j]);
+        dim.data_type = UDA_TYPE_DOUBLE;
+        dim.compressed = 1;
+        dim.method = 0;
+        dim.dim0 = 0.0;
+        dim.diff = 1.0;
+        data_block.data_n *= dim.dim_n;
+    }
+    DIMS& dim0 = data_block.dims[0];
+    dim0.compressed = 0;
+    auto* coords = new_array<double>(shape[0]);
+    for (size_t i = 0; i < shape[0]; ++i) {
+        coords[i] = 10.0 * static_cast<double>(i);
+    }
+    dim0.dim = reinterpret_cast<char*>(coords);
+
+    auto* data = new_array<double>(data_block.data_n);
+    for (int i = 0; i < data_block.data_n; ++i) {
+        data[i] = static_cast<double>(i);
+    }
+    data_block.data = reinterpret_cast<char*>(data);
+}
+
+} // namespace
+
+TEST(SlicingTest, ParseIndex) {
+    SliceSpec spec;
+    ASSERT_EQ(parse_slice_spec("3", spec), 0);
+    EXPECT_TRUE(spec.is_index);
+    EXPECT_EQ(spec.start, 3);
+
+    ASSERT_EQ(parse_slice_spec(" -1 ", spec), 0);
+    EXPECT_TRUE(spec.is_index);
+    EXPECT_EQ(spec.start, -1);
+}
+
+TEST(SlicingTest, ParseRanges) {
+    SliceSpec spec;
+    ASSERT_EQ(parse_slice_spec(":", spec), 0);
+    EXPECT_FALSE(spec.is_index);
+    EXPECT_EQ(spec.start, 0);
+    EXPECT_FALSE(spec.has_stop);
+    EXPECT_EQ(spec.step, 1);
+
+    ASSERT_EQ(parse_slice_spec("2:10:3", spec), 0);
+    EXPECT_FALSE(spec.is_index);
+    EXPECT_EQ(spec.start, 2);
+    EXPECT_TRUE(spec.has_stop);
+    EXPECT_EQ(spec.stop, 10);
+    EXPECT_EQ(spec.step, 3);
+
+    ASSERT_EQ(parse_slice_spec("-3:", spec), 0);
+    EXPECT_EQ(spec.start, -3);
+    EXPECT_FALSE(spec.has_stop);
+
+    ASSERT_EQ(parse_slice_spec("::2", spec), 0);
+    EXPECT_FALSE(spec.has_stop);
+    EXPECT_EQ(spec.step, 2);
+}
+
+TEST(SlicingTest, ParseMalformed) {
+    SliceSpec spec;
+    EXPECT_NE(parse_slice_spec("", spec), 0);
+    EXPECT_NE(parse_slice_spec("a", spec), 0);
+    EXPECT_NE(parse_slice_spec("1:x", spec), 0);
+    EXPECT_NE(parse_slice_spec("::0", spec), 0);
+    EXPECT_NE(parse_slice_spec("0:4:-1", spec), 0);
+}
+
+TEST(SlicingTest, ResolveNegativeAndOpen) {
+    std::vector<DimSelection> selection;
+    ASSERT_EQ(resolve_slice(parse_specs({"-1", "1:-1", "::2"}), {5, 6, 7, 8},
+                            selection),
+              0);
+    ASSERT_EQ(selection.size(), 4U);
+
+    EXPECT_TRUE(selection[0].drop);
+    EXPECT_EQ(selection[0].start, 4U);
+    EXPECT_EQ(selection[0].count, 1U);
+
+    EXPECT_FALSE(selection[1].drop);
+    EXPECT_EQ(selection[1].start, 1U);
+    EXPECT_EQ(selection[1].count, 4U);
+
+    EXPECT_EQ(selection[2].start, 0U);
+    EXPECT_EQ(selection[2].step, 2U);
+    EXPECT_EQ(selection[2].count, 4U);
+
+    // No spec, kept whole
+    EXPECT_FALSE(selection[3].drop);
+    EXPECT_EQ(selection[3].count, 8U);
+}
+
+TEST(SlicingTest, ResolveRejects) {
+    std::vector<DimSelection> selection;
+    // Index out of range, either end
+    EXPECT_NE(resolve_slice(parse_specs({"5"}), {5}, selection), 0);
+    EXPECT_NE(resolve_slice(parse_specs({"-6"}), {5}, selection), 0);
+    // Empty ranges
+    EXPECT_NE(resolve_slice(parse_specs({"3:3"}), {5}, selection), 0);
+    EXPECT_NE(resolve_slice(parse_specs({"4:1"}), {5}, selection), 0);
+    EXPECT_NE(resolve_slice(parse_specs({"7:"}), {5}, selection), 0);
+    // More specs than dimensions
+    EXPECT_NE(resolve_slice(parse_specs({":", ":"}), {5}, selection), 0);
+}
+
+TEST(SlicingTest, ShapeDropsIndexedDims) {
+    std::vector<size_t> shape;
+    ASSERT_EQ(slice_shape(parse_specs({"1:4:2", "-1"}), {4, 3, 5}, shape), 0);
+    EXPECT_EQ(shape, (std::vector<size_t>{2, 5}));
+
+    ASSERT_EQ(slice_shape(parse_specs({"0"}), {4}, shape), 0);
+    EXPECT_TRUE(shape.empty());
+}
+
+// Rank 3 gather checked element by element against a naive copy
+TEST(SlicingTest, GatherRank3MatchesNaiveCopy) {
+    const std::vector<size_t> shape{4, 3, 5};
+    DATA_BLOCK data_block;
+    make_block(data_block, shape);
+    data_block.order = 2;
+
+    ASSERT_EQ(slice_data_block(&data_block,
+                               parse_specs({"1:4:2", "-1", "::2"})),
+              0);
+
+    // Kept dims 0 (1, 3) and 2 (0, 2, 4), dim 1 fixed at index 2
+    std::vector<double> expected;
+    for (size_t k = 0; k < shape[2]; k += 2) {
+        for (size_t i = 1; i < shape[0]; i += 2) {
+            expected.push_back(
+                static_cast<double>(i + shape[0] * (2 + shape[1] * k)));
+        }
+    }
+
+    ASSERT_EQ(data_block.rank, 2U);
+    ASSERT_EQ(data_block.data_n, static_cast<int>(expected.size()));
+    const auto* data = reinterpret_cast<const double*>(data_block.data);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(data[i], expected[i]) << "element " << i;
+    }
+
+    // Coordinate array gathered
+    const DIMS& dim0 = data_block.dims[0];
+    ASSERT_EQ(dim0.dim_n, 2);
+    ASSERT_EQ(dim0.compressed, 0);
+    const auto* coords = reinterpret_cast<const double*>(dim0.dim);
+    EXPECT_EQ(coords[0], 10.0);
+    EXPECT_EQ(coords[1], 30.0);
+
+    // Compressed dims[2] moved down to dims[1], its start and step scaled
+    const DIMS& dim1 = data_block.dims[1];
+    EXPECT_EQ(dim1.dim_n, 3);
+    EXPECT_EQ(dim1.compressed, 1);
+    EXPECT_EQ(dim1.dim0, 0.0);
+    EXPECT_EQ(dim1.diff, 2.0);
+
+    // order followed its dimension
+    EXPECT_EQ(data_block.order, 1);
+
+    freeDataBlock(&data_block);
+}
+
+TEST(SlicingTest, OrderOfDroppedDimCleared) {
+    DATA_BLOCK data_block;
+    make_block(data_block, {4, 3});
+    data_block.order = 1;
+
+    ASSERT_EQ(slice_data_block(&data_block, parse_specs({":", "0"})), 0);
+    EXPECT_EQ(data_block.rank, 1U);
+    EXPECT_EQ(data_block.data_n, 4);
+    EXPECT_EQ(data_block.order, -1);
+
+    freeDataBlock(&data_block);
+}
+
+TEST(SlicingTest, AllDimsIndexedGivesScalar) {
+    DATA_BLOCK data_block;
+    make_block(data_block, {4, 3});
+
+    ASSERT_EQ(slice_data_block(&data_block, parse_specs({"-1", "1"})), 0);
+    EXPECT_EQ(data_block.rank, 0U);
+    EXPECT_EQ(data_block.data_n, 1);
+    EXPECT_EQ(data_block.dims, nullptr);
+    EXPECT_EQ(reinterpret_cast<const double*>(data_block.data)[0], 7.0);
+
+    freeDataBlock(&data_block);
+}
+
+// A rejected slice leaves the data_block as it was mapped
+TEST(SlicingTest, RejectedSliceLeavesBlockUntouched) {
+    DATA_BLOCK data_block;
+    make_block(data_block, {4, 3});
+
+    EXPECT_NE(slice_data_block(&data_block, parse_specs({"1:3", "3"})), 0);
+    EXPECT_EQ(data_block.rank, 2U);
+    EXPECT_EQ(data_block.data_n, 12);
+    EXPECT_EQ(data_block.dims[0].dim_n, 4);
+    EXPECT_EQ(data_block.dims[1].dim_n, 3);
+    EXPECT_EQ(reinterpret_cast<const double*>(data_block.data)[1], 1.0);
+
+    freeDataBlock(&data_block);
+}
@@ -0,0 +1,58 @@
+#include "handlers/map_register.hpp"
+#include "map_types/base_entry.hpp"
+
+#include <clientserver/freeDataBlock.h>
+#include <clientserver/initStructs.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+int map_value(const ValueEntry& entry, DATA_BLOCK* data_block) {
+    IDAM_PLUGIN_INTERFACE interface{};
+    interface.data_block = data_block;
+    IDSMapRegister entries;
+    RequestContext request;
+    return entry.map(&interface, entries, nlohmann::json::object(), request);
+}
+
+} // namespace
+
+// An array VALUE must be mapped as that array, not wrapped in another one
+TEST(ValueEntryTest, ArrayValueKeepsShape) {
+    const ValueEntry entry{nlohmann::json{1.5, 2.5, 3.5}};
+
+    DATA_BLOCK data_block;
+    initDataBlock(&data_block);
+    ASSERT_EQ(map_value(entry, &data_block), 0);
+    EXPECT_EQ(data_block.rank, 1U);
+    EXPECT_EQ(data_block.data_n, 3);
+    ASSERT_EQ(data_block.data_type, UDA_TYPE_FLOAT);
+    const auto* data = reinterpret_cast<const float*>(data_block.data);
+    EXPECT_FLOAT_EQ(data[0], 1.5F);
+    EXPECT_FLOAT_EQ(data[2], 3.5F);
+    freeDataBlock(&data_block);
+}
+
+TEST(ValueEntryTest, ArrayValueShape) {
+    const ValueEntry entry{nlohmann::json{1, 2, 3, 4}};
+
+    IDAM_PLUGIN_INTERFACE interface{};
+    IDSMapRegister entries;
+    RequestContext request;
+    std::vector<size_t> shape;
+    ASSERT_EQ(entry.shape(&interface, entries, nlohmann::json::object(),
+                          request, shape),
+              0);
+    EXPECT_EQ(shape, std::vector<size_t>{4});
+}
+
+TEST(ValueEntryTest, ScalarValue) {
+    const ValueEntry entry{nlohmann::json(3.5)};
+
+    DATA_BLOCK data_block;
+    initDataBlock(&data_block);
+    ASSERT_EQ(map_value(entry, &data_block), 0);
+    EXPECT_EQ(data_block.rank, 0U);
+    EXPECT_EQ(data_block.data_n, 1);
+    freeDataBlock(&data_block);
+}
@@ -0,0 +1,35 @@
+/*
+ * Offline compiler for binary mapping bundles
+ *
+ * Compiles a JSON mapping directory (as JSON_MAPPING_DIR) into a single
+ * bundle file, loaded by the plugin when JSON_MAPPING_BUNDLE is set. The
+ * bundle must be recompiled whenever the mapping files change.
+ *
+ * Usage: jmp_compile_bundle <mapping_dir> <bundle_path>
+ */
+#include "handlers/mapping_bundle.hpp"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <mapping_dir> <bundle_path>\n";
+        return 2;
+    }
+    std::string error;
+    if (JMP::bundle::compile_bundle(argv[1], argv[2], error) != 0) {
+        std::cerr << argv[0] << ": " << error << "\n";
+        return 1;
+    }
+
+    // Read back to validate what was written
+    JMP::bundle::MappingBundle bundle;
+    if (bundle.open(argv[2], error) != 0) {
+        std::cerr << argv[0] << ": " << error << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << argv[2] << "\n";
+    return 0;
+}
@@ -4,6 +4,9 @@ set(SOURCES
     JSON_mapping_plugin.cpp
     src/tmp.cpp
     src/handlers/mapping_handler.cpp
+    src/handlers/map_register.cpp
+    src/handlers/mapping_bundle.cpp
+    src/handlers/result_cache.cpp
     src/map_types/base_entry.cpp
     src/map_types/map_entry.cpp
     src/map_types/dim_entry.cpp
@@ -12,6 +15,13 @@ set(SOURCES
     src/map_types/custom_entry.cpp
     src/utils/uda_plugin_helpers.cpp
     src/utils/scale_offset.cpp
+    src/utils/convert.cpp
+    src/utils/slicing.cpp
+    src/utils/template_string.cpp
+    src/utils/worker_pool.cpp
+    src/utils/logger.cpp
+    src/utils/getmany_result.cpp
+    src/utils/file_watcher.cpp
 )
 
 #set(EXE_SOURCES
@@ -22,6 +32,9 @@ set(HEADERS
     JSON_mapping_plugin.h
     src/tmp.hpp
     src/handlers/mapping_handler.hpp
+    src/handlers/map_register.hpp
+    src/handlers/mapping_bundle.hpp
+    src/handlers/result_cache.hpp
     src/map_types/base_entry.hpp
     src/map_types/map_entry.hpp
     src/map_types/dim_entry.hpp
@@ -30,6 +43,20 @@ set(HEADERS
     src/map_types/custom_entry.hpp
     src/utils/uda_plugin_helpers.hpp
     src/utils/scale_offset.hpp
+    src/utils/convert.hpp
+    src/utils/slicing.hpp
+    src/utils/template_string.hpp
+    src/utils/worker_pool.hpp
+    src/utils/logger.hpp
+    src/utils/getmany_result.hpp
+    src/utils/ids_path.hpp
+    src/utils/uda_type_traits.hpp
+    src/utils/file_watcher.hpp
+)
+
+set(BUNDLE_COMPILER_SOURCES
+    tools/compile_mapping_bundle.cpp
+    src/handlers/mapping_bundle.cpp
 )
 
 set(INCLUDE_DIRS
@@ -40,4 +67,10 @@ set(INCLUDE_DIRS
 
 set(TEST_SOURCES
     src/tmp_test.cpp
+    src/value_entry_test.cpp
+    src/slicing_test.cpp
+)
+
+set(BENCHMARK_SOURCES
+    src/mapping_benchmark.cpp
 )
@@ -19,6 +19,24 @@ option(
     "Use the GoogleTest project for creating unit tests." ON
 )
 
+#
+# Tools
+#
+option(
+    ${PROJECT_NAME}_BUILD_BUNDLE_COMPILER
+    "Build jmp_compile_bundle, the offline mapping bundle compiler." ON
+)
+
+#
+# Benchmarks
+#
+# Google Benchmark suite, built alongside the unit tests. Configure with
+# CMAKE_BUILD_TYPE=Release for meaningful timings.
+option(
+    ${PROJECT_NAME}_ENABLE_BENCHMARKS
+    "Build the Google Benchmark suite (from the `test` subfolder)." OFF
+)
+
 #
 # Static analyzers
 #